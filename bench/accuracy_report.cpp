@@ -0,0 +1,121 @@
+// Compares --mode=fast estimates against exact scores, per language.
+//
+//   catchy_accuracy [path...]
+//
+// Every given file or directory (recursively), the examples/ directory when
+// none is given, is analyzed in both modes along with a synthetic corpus of
+// nested loops and conditionals.
+// Functions are matched by file, name and start line.
+#include "synthetic_source.hpp"
+#include "analysis/analyzer.hpp"
+#include <spdlog/spdlog.h>
+#include <tabulate/table.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string_view>
+#include <tuple>
+#include <unistd.h>
+
+namespace {
+
+using catchy::analysis::Analyzer;
+using catchy::analysis::ResultStore;
+using catchy::analysis::ScoringMode;
+
+struct Accuracy {
+    size_t matched {0};
+    size_t exact_only {0};
+    size_t fast_only {0};
+    size_t equal {0};
+    size_t total_error {0};
+    size_t max_error {0};
+};
+
+ResultStore analyze(const std::filesystem::path& path, ScoringMode mode) {
+    Analyzer analyzer;
+    analyzer.set_mode(mode);
+    // Compare against tree-sitter even where parse errors dominate a file
+    catchy::analysis::ParseLimits limits;
+    limits.max_error_percent = 100;
+    analyzer.set_limits(limits);
+    if (std::filesystem::is_directory(path)) {
+        return analyzer.analyze_directory(path.string(), true);
+    }
+    return analyzer.analyze_file(path.string());
+}
+
+void compare(const std::filesystem::path& path, std::map<std::string, Accuracy>& accuracy) {
+    using Key = std::tuple<std::string_view, std::string_view, size_t>;
+    auto fast_results = analyze(path, ScoringMode::Fast);
+    std::map<Key, ResultStore::Row> fast;
+    for (auto result : fast_results) {
+        fast.emplace(Key{result.file_path().str(), result.function_name(), result.start_line()}, result);
+    }
+
+    auto exact_results = analyze(path, ScoringMode::Exact);
+    for (auto result : exact_results) {
+        auto& language = accuracy[result.language()];
+        auto it = fast.find(Key{result.file_path().str(), result.function_name(), result.start_line()});
+        if (it == fast.end()) {
+            language.exact_only++;
+            continue;
+        }
+        size_t estimate = it->second.complexity();
+        size_t complexity = result.complexity();
+        size_t error = std::max(estimate, complexity) - std::min(estimate, complexity);
+        language.matched++;
+        language.equal += error == 0;
+        language.total_error += error;
+        language.max_error = std::max(language.max_error, error);
+        fast.erase(it);
+    }
+    for (const auto& [key, result] : fast) {
+        accuracy[result.language()].fast_only++;
+    }
+}
+
+std::filesystem::path write_corpus() {
+    auto dir = std::filesystem::temp_directory_path() / ("catchy_accuracy_" + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+    for (size_t depth = 0; depth <= 6; ++depth) {
+        auto name = "depth_" + std::to_string(depth);
+        std::ofstream(dir / (name + ".cpp")) << catchy::bench::make_cpp_source(20, depth);
+        std::ofstream(dir / (name + ".py")) << catchy::bench::make_python_source(20, depth);
+    }
+    return dir;
+}
+
+std::string percent(size_t part, size_t whole) {
+    return whole ? fmt::format("{:.1f}%", 100.0 * static_cast<double>(part) / static_cast<double>(whole)) : "-";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::err);
+
+    std::map<std::string, Accuracy> accuracy;
+    for (int i = 1; i < argc; ++i) {
+        compare(argv[i], accuracy);
+    }
+    if (argc == 1) {
+        compare(CATCHY_EXAMPLES_DIR, accuracy);
+    }
+    auto corpus = write_corpus();
+    compare(corpus, accuracy);
+    std::filesystem::remove_all(corpus);
+
+    tabulate::Table table;
+    table.add_row({"Language", "Matched", "Exact only", "Fast only", "Equal", "Mean error", "Max error"});
+    for (const auto& [language, a] : accuracy) {
+        auto mean = a.matched ? static_cast<double>(a.total_error) / static_cast<double>(a.matched) : 0.0;
+        table.add_row({language, std::to_string(a.matched), std::to_string(a.exact_only),
+                       std::to_string(a.fast_only), percent(a.equal, a.matched),
+                       fmt::format("{:.2f}", mean), std::to_string(a.max_error)});
+    }
+    std::cout << "\nFast mode accuracy:\n" << table << std::endl;
+    return 0;
+}
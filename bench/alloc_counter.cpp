@@ -0,0 +1,39 @@
+#include "alloc_counter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<size_t> g_allocations{0};
+std::atomic<size_t> g_bytes{0};
+
+void* counted_alloc(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+namespace catchy::bench {
+
+size_t allocation_count() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+size_t allocated_bytes() {
+    return g_bytes.load(std::memory_order_relaxed);
+}
+
+} // namespace catchy::bench
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
@@ -0,0 +1,16 @@
+#ifndef CATCHY_BENCH_ALLOC_COUNTER_HPP
+#define CATCHY_BENCH_ALLOC_COUNTER_HPP
+
+#pragma once
+
+#include <cstddef>
+
+namespace catchy::bench {
+
+// Totals of every global operator new call made by the benchmark binary
+size_t allocation_count();
+size_t allocated_bytes();
+
+} // namespace catchy::bench
+
+#endif // CATCHY_BENCH_ALLOC_COUNTER_HPP
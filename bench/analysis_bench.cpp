@@ -0,0 +1,196 @@
+#include "alloc_counter.hpp"
+#include "synthetic_source.hpp"
+#include "temp_files.hpp"
+#include "analysis/analyzer.hpp"
+#include "utils/arena.hpp"
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+#include <filesystem>
+#include <unordered_map>
+#include <sys/resource.h>
+
+namespace {
+
+using catchy::analysis::AnalysisResult;
+using catchy::analysis::Analyzer;
+using catchy::analysis::ResultStore;
+using catchy::analysis::ScoringMode;
+using catchy::bench::write_temp_source;
+
+// Full results versus --aggregate-only on the same file, reporting the
+// allocations made per analyzed file
+void BM_AnalyzeFileAllocations(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::warn);
+    auto functions = static_cast<size_t>(state.range(0));
+    bool aggregate_only = state.range(1) != 0;
+    auto path = write_temp_source(
+        "alloc_" + std::to_string(functions) + ".cpp",
+        catchy::bench::make_cpp_source(functions, 3));
+
+    Analyzer analyzer;
+    analyzer.set_aggregate_only(aggregate_only);
+
+    size_t allocations = 0;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        size_t allocations_before = catchy::bench::allocation_count();
+        size_t bytes_before = catchy::bench::allocated_bytes();
+        auto results = analyzer.analyze_file(path);
+        benchmark::DoNotOptimize(results);
+        allocations += catchy::bench::allocation_count() - allocations_before;
+        bytes += catchy::bench::allocated_bytes() - bytes_before;
+    }
+
+    state.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    state.counters["alloc_bytes"] = benchmark::Counter(
+        static_cast<double>(bytes), benchmark::Counter::kAvgIterations);
+    state.counters["functions/s"] = benchmark::Counter(
+        static_cast<double>(functions * state.iterations()), benchmark::Counter::kIsRate);
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_AnalyzeFileAllocations)
+    ->ArgsProduct({{100, 1000}, {0, 1}})
+    ->ArgNames({"functions", "aggregate_only"})
+    ->Unit(benchmark::kMillisecond);
+
+// Exact scoring versus --mode=fast on the same file
+void BM_ScoringMode(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::warn);
+    auto functions = static_cast<size_t>(state.range(0));
+    bool python = state.range(1) != 0;
+    auto mode = state.range(2) != 0 ? ScoringMode::Fast : ScoringMode::Exact;
+    auto path = python
+        ? write_temp_source("mode_" + std::to_string(functions) + ".py",
+                            catchy::bench::make_python_source(functions, 4))
+        : write_temp_source("mode_" + std::to_string(functions) + ".cpp",
+                            catchy::bench::make_cpp_source(functions, 4));
+
+    Analyzer analyzer;
+    analyzer.set_mode(mode);
+    analyzer.set_prefilter(false);
+
+    for (auto _ : state) {
+        auto results = analyzer.analyze_file(path);
+        benchmark::DoNotOptimize(results);
+    }
+
+    state.counters["functions/s"] = benchmark::Counter(
+        static_cast<double>(functions * state.iterations()), benchmark::Counter::kIsRate);
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_ScoringMode)
+    ->ArgsProduct({{100, 1000}, {0, 1}, {0, 1}})
+    ->ArgNames({"functions", "python", "fast"})
+    ->Unit(benchmark::kMillisecond);
+
+// Threshold 15 on a file where one function in 20 reaches it: with the
+// prefilter, only those are scored exactly
+void BM_TwoTierScoring(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::warn);
+    auto functions = static_cast<size_t>(state.range(0));
+    bool prefilter = state.range(1) != 0;
+    auto path = write_temp_source(
+        "two_tier_" + std::to_string(functions) + ".cpp",
+        catchy::bench::make_cpp_source(functions, [](size_t f) { return f % 20 == 0 ? 6 : 2; }));
+
+    Analyzer analyzer;
+    analyzer.set_complexity_threshold(15);
+    analyzer.set_prefilter(prefilter);
+
+    for (auto _ : state) {
+        auto results = analyzer.analyze_file(path);
+        benchmark::DoNotOptimize(results);
+    }
+
+    state.counters["functions/s"] = benchmark::Counter(
+        static_cast<double>(functions * state.iterations()), benchmark::Counter::kIsRate);
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_TwoTierScoring)
+    ->ArgsProduct({{100, 1000}, {0, 1}})
+    ->ArgNames({"functions", "prefilter"})
+    ->Unit(benchmark::kMillisecond);
+
+// Per-file arena versus the heap. Run each variant on its own
+// (--benchmark_filter) to compare peak RSS, which is per process.
+void BM_ArenaAllocations(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::warn);
+    auto functions = static_cast<size_t>(state.range(0));
+    bool arena = state.range(1) != 0;
+    auto path = write_temp_source(
+        "arena_" + std::to_string(functions) + ".cpp",
+        catchy::bench::make_cpp_source(functions, 3));
+
+    Analyzer analyzer;
+    analyzer.set_use_arena(arena);
+
+    size_t allocations = 0;
+    size_t tree_sitter_allocations = 0;
+    for (auto _ : state) {
+        size_t allocations_before = catchy::bench::allocation_count();
+        size_t tree_sitter_before = catchy::utils::tree_sitter_heap_allocations();
+        auto results = analyzer.analyze_file(path);
+        benchmark::DoNotOptimize(results);
+        allocations += catchy::bench::allocation_count() - allocations_before;
+        tree_sitter_allocations += catchy::utils::tree_sitter_heap_allocations() - tree_sitter_before;
+    }
+
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    state.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    state.counters["ts_mallocs"] = benchmark::Counter(
+        static_cast<double>(tree_sitter_allocations), benchmark::Counter::kAvgIterations);
+    state.counters["peak_rss_kb"] = static_cast<double>(usage.ru_maxrss);
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_ArenaAllocations)
+    ->ArgsProduct({{100, 1000}, {0, 1}})
+    ->ArgNames({"functions", "arena"})
+    ->Unit(benchmark::kMillisecond);
+
+// Sorting and per-file totals over a large result store, as done for the
+// snapshot and the summary
+void BM_ResultStoreSortAndTotal(benchmark::State& state) {
+    auto rows = static_cast<size_t>(state.range(0));
+    ResultStore store;
+    std::vector<catchy::utils::InternedString> paths;
+    for (size_t i = 0; i < 1000; ++i) {
+        paths.emplace_back("src/module_" + std::to_string(i) + ".cpp");
+    }
+    for (size_t i = 0; i < rows; ++i) {
+        AnalysisResult result;
+        result.file_path = paths[(i * 7919) % paths.size()];
+        result.function_name = "function_" + std::to_string(i % 997);
+        result.start_line = i % 5000;
+        result.end_line = result.start_line + 10;
+        result.complexity = i % 40;
+        store.append(std::move(result));
+    }
+
+    size_t allocations = 0;
+    for (auto _ : state) {
+        size_t allocations_before = catchy::bench::allocation_count();
+        auto order = store.sorted_rows();
+        std::unordered_map<catchy::utils::InternedString, size_t> per_file;
+        for (uint32_t row : order) {
+            per_file[store[row].file_path()] += store[row].complexity();
+        }
+        benchmark::DoNotOptimize(per_file);
+        allocations += catchy::bench::allocation_count() - allocations_before;
+    }
+
+    state.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    state.counters["store_bytes"] = static_cast<double>(store.memory_usage());
+    state.counters["rows/s"] = benchmark::Counter(
+        static_cast<double>(rows * state.iterations()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ResultStoreSortAndTotal)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->ArgName("rows")
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
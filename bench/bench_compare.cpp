@@ -0,0 +1,313 @@
+// Compares a catchy_bench JSON run against the stored baseline and fails when
+// a benchmark got slower than its tolerance allows.
+//
+//   catchy_bench_compare <baseline.json> <results.json>
+//   catchy_bench_compare --update <baseline.json> <results.json>
+//
+// Results should come from --benchmark_repetitions runs; the median of the
+// repetitions is compared, which keeps single noisy runs from failing the
+// gate. --update rewrites the baseline times from the results and keeps its
+// tolerances. A baseline without times fails the comparison.
+//
+// Baseline format:
+//   {
+//     "tolerance": 0.1,                        default allowed slowdown
+//     "tolerances": {"BM_AnalyzeDirectory": 0.25},  by longest name prefix
+//     "context": {"host_name": ..., "num_cpus": ...},
+//     "benchmarks": {"<name>": <real time in ns>, ...}
+//   }
+#include <fmt/format.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <tabulate/table.hpp>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+static cl::OptionCategory CompareCategory("Compare Options");
+
+static cl::opt<std::string> BaselinePath(
+    cl::Positional,
+    cl::desc("<baseline.json>"),
+    cl::Required,
+    cl::cat(CompareCategory));
+
+static cl::opt<std::string> ResultsPath(
+    cl::Positional,
+    cl::desc("<results.json>"),
+    cl::Required,
+    cl::cat(CompareCategory));
+
+static cl::opt<bool> Update(
+    "update",
+    cl::desc("Replace the baseline times with the results instead of comparing"),
+    cl::init(false),
+    cl::cat(CompareCategory));
+
+namespace {
+
+struct Baseline {
+    double tolerance {0.1};
+    std::map<std::string, double> tolerances;
+    json::Object context;
+    std::map<std::string, double> benchmarks;
+
+    double tolerance_for(const std::string& name) const {
+        double found = tolerance;
+        size_t longest = 0;
+        for (const auto& [prefix, value] : tolerances) {
+            if (prefix.size() >= longest && name.compare(0, prefix.size(), prefix) == 0) {
+                found = value;
+                longest = prefix.size();
+            }
+        }
+        return found;
+    }
+};
+
+struct Results {
+    json::Object context;
+    // Real time in nanoseconds by benchmark name
+    std::map<std::string, double> benchmarks;
+};
+
+json::Value read_json(const std::string& path) {
+    auto buffer = MemoryBuffer::getFile(path);
+    if (!buffer) {
+        throw std::runtime_error("Cannot read " + path + ": " + buffer.getError().message());
+    }
+    auto value = json::parse((*buffer)->getBuffer());
+    if (!value) {
+        throw std::runtime_error("Invalid JSON in " + path + ": " + toString(value.takeError()));
+    }
+    return std::move(*value);
+}
+
+const json::Object& as_object(const json::Value& value, const std::string& what) {
+    const auto* object = value.getAsObject();
+    if (!object) {
+        throw std::runtime_error(what + " is not a JSON object");
+    }
+    return *object;
+}
+
+Baseline read_baseline(const std::string& path) {
+    auto value = read_json(path);
+    const auto& root = as_object(value, path);
+    Baseline baseline;
+    if (auto tolerance = root.getNumber("tolerance")) {
+        baseline.tolerance = *tolerance;
+    }
+    if (const auto* tolerances = root.getObject("tolerances")) {
+        for (const auto& [prefix, tolerance] : *tolerances) {
+            if (auto number = tolerance.getAsNumber()) {
+                baseline.tolerances[prefix.str()] = *number;
+            }
+        }
+    }
+    if (const auto* context = root.getObject("context")) {
+        baseline.context = *context;
+    }
+    if (const auto* benchmarks = root.getObject("benchmarks")) {
+        for (const auto& [name, time] : *benchmarks) {
+            if (auto number = time.getAsNumber()) {
+                baseline.benchmarks[name.str()] = *number;
+            }
+        }
+    }
+    return baseline;
+}
+
+double to_nanoseconds(double time, StringRef unit) {
+    if (unit == "us") return time * 1e3;
+    if (unit == "ms") return time * 1e6;
+    if (unit == "s") return time * 1e9;
+    return time;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+// Takes the median aggregate of each benchmark where there is one, and the
+// median of its iteration runs otherwise
+Results read_results(const std::string& path) {
+    auto value = read_json(path);
+    const auto& root = as_object(value, path);
+    const auto* entries = root.getArray("benchmarks");
+    if (!entries) {
+        throw std::runtime_error(path + " has no benchmarks; is it --benchmark_out JSON?");
+    }
+
+    std::map<std::string, std::vector<double>> runs;
+    std::map<std::string, double> medians;
+    for (const auto& entry : *entries) {
+        const auto* benchmark = entry.getAsObject();
+        if (!benchmark) {
+            continue;
+        }
+        auto name = benchmark->getString("run_name");
+        if (!name) {
+            name = benchmark->getString("name");
+        }
+        auto time = benchmark->getNumber("real_time");
+        if (!name || !time || benchmark->getString("error_message")) {
+            continue;
+        }
+        auto nanoseconds = to_nanoseconds(*time, benchmark->getString("time_unit").value_or("ns"));
+        auto aggregate = benchmark->getString("aggregate_name");
+        if (!aggregate) {
+            runs[name->str()].push_back(nanoseconds);
+        } else if (*aggregate == "median") {
+            medians[name->str()] = nanoseconds;
+        }
+    }
+
+    Results results;
+    if (const auto* context = root.getObject("context")) {
+        results.context = *context;
+    }
+    for (const auto& [name, times] : runs) {
+        results.benchmarks[name] = median(times);
+    }
+    for (const auto& [name, time] : medians) {
+        results.benchmarks[name] = time;
+    }
+    return results;
+}
+
+// Only what tells two machines apart; times from another host are not
+// comparable
+json::Object machine(const json::Object& context) {
+    json::Object kept;
+    for (const char* key : {"host_name", "num_cpus", "mhz_per_cpu", "library_build_type"}) {
+        if (const auto* value = context.get(key)) {
+            kept[key] = *value;
+        }
+    }
+    return kept;
+}
+
+void write_baseline(const std::string& path, const Baseline& baseline, const Results& results) {
+    json::Object tolerances;
+    for (const auto& [prefix, tolerance] : baseline.tolerances) {
+        tolerances[prefix] = tolerance;
+    }
+    json::Object benchmarks;
+    for (const auto& [name, time] : results.benchmarks) {
+        benchmarks[name] = time;
+    }
+    json::Object root{
+        {"tolerance", baseline.tolerance},
+        {"tolerances", std::move(tolerances)},
+        {"context", machine(results.context)},
+        {"benchmarks", std::move(benchmarks)},
+    };
+
+    std::error_code error;
+    raw_fd_ostream out(path, error, sys::fs::OF_Text);
+    if (error) {
+        throw std::runtime_error("Cannot write " + path + ": " + error.message());
+    }
+    out << formatv("{0:2}", json::Value(std::move(root))) << "\n";
+}
+
+std::string format_time(double nanoseconds) {
+    if (nanoseconds >= 1e9) return fmt::format("{:.2f} s", nanoseconds / 1e9);
+    if (nanoseconds >= 1e6) return fmt::format("{:.2f} ms", nanoseconds / 1e6);
+    if (nanoseconds >= 1e3) return fmt::format("{:.2f} us", nanoseconds / 1e3);
+    return fmt::format("{:.1f} ns", nanoseconds);
+}
+
+void warn_on_other_machine(const Baseline& baseline, const Results& results) {
+    auto current = machine(results.context);
+    for (const char* key : {"host_name", "num_cpus"}) {
+        const auto* stored = baseline.context.get(key);
+        const auto* now = current.get(key);
+        if (stored && now && *stored != *now) {
+            std::cerr << "warning: baseline was recorded with a different " << key
+                      << "; times may not be comparable\n";
+        }
+    }
+    if (auto build = current.getString("library_build_type"); build && *build == "debug") {
+        std::cerr << "warning: google benchmark is a debug build; times may be noisy\n";
+    }
+}
+
+int compare(const Baseline& baseline, const Results& results) {
+    warn_on_other_machine(baseline, results);
+
+    tabulate::Table table;
+    table.add_row({"Benchmark", "Baseline", "Current", "Change", "Tolerance", "Status"});
+    size_t slower = 0;
+    size_t missing = 0;
+    size_t within = 0;
+    size_t added = 0;
+    for (const auto& [name, base] : baseline.benchmarks) {
+        auto tolerance = baseline.tolerance_for(name);
+        auto it = results.benchmarks.find(name);
+        if (it == results.benchmarks.end()) {
+            table.add_row({name, format_time(base), "-", "-", fmt::format("{:.0f}%", tolerance * 100), "missing"});
+            missing++;
+            continue;
+        }
+        double change = base > 0 ? it->second / base - 1 : 0;
+        if (change > tolerance) {
+            table.add_row({name, format_time(base), format_time(it->second), fmt::format("{:+.1f}%", change * 100),
+                           fmt::format("{:.0f}%", tolerance * 100), "slower"});
+            slower++;
+        } else {
+            within++;
+        }
+    }
+    for (const auto& [name, time] : results.benchmarks) {
+        added += baseline.benchmarks.count(name) == 0;
+    }
+
+    if (slower + missing > 0) {
+        std::cout << "\nPerformance regressions:\n" << table << std::endl;
+    }
+    std::cout << within << " within tolerance, " << slower << " slower, " << missing << " missing, " << added
+              << " not in the baseline\n";
+    return slower + missing > 0 ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    cl::HideUnrelatedOptions(CompareCategory);
+    cl::ParseCommandLineOptions(argc, argv, "Catchy benchmark regression gate\n");
+
+    try {
+        auto baseline = read_baseline(BaselinePath);
+        auto results = read_results(ResultsPath);
+        if (Update) {
+            write_baseline(BaselinePath, baseline, results);
+            std::cout << "Wrote " << results.benchmarks.size() << " benchmark times to " << BaselinePath.getValue()
+                      << "\n";
+            return 0;
+        }
+        // A gate with nothing to compare against must not pass
+        if (baseline.benchmarks.empty()) {
+            std::cerr << "catchy_bench_compare: no baseline recorded in " << BaselinePath.getValue()
+                      << "; run catchy_bench_baseline on this machine first\n";
+            return 1;
+        }
+        return compare(baseline, results);
+    } catch (const std::exception& e) {
+        std::cerr << "catchy_bench_compare: " << e.what() << "\n";
+        return 2;
+    }
+}
@@ -0,0 +1,338 @@
+#include "corpus.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace catchy::bench {
+
+namespace {
+
+// splitmix64, with distributions built on it so output is identical
+// everywhere
+class Random {
+public:
+    explicit Random(uint64_t seed) : state_(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state_ += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, bound]
+    size_t upto(size_t bound) { return static_cast<size_t>(next() % (uint64_t{bound} + 1)); }
+
+    // Uniform in (0, 1]
+    double unit() { return static_cast<double>((next() >> 11) + 1) * 0x1.0p-53; }
+
+    bool chance(double probability) { return unit() <= probability; }
+
+    // Approximately standard normal: the sum of twelve uniforms, which needs
+    // no math library function whose rounding could vary
+    double normal() {
+        double sum = 0.0;
+        for (int i = 0; i < 12; ++i) {
+            sum += unit();
+        }
+        return sum - 6.0;
+    }
+
+private:
+    uint64_t state_;
+};
+
+// e^x from a Taylor series after halving x into [-1, 1], for the same
+// reason as Random::normal
+double exponential(double x) {
+    int squarings = 0;
+    while (x > 1.0 || x < -1.0) {
+        x /= 2.0;
+        ++squarings;
+    }
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 20; ++n) {
+        term *= x / n;
+        sum += term;
+    }
+    while (squarings-- > 0) {
+        sum *= sum;
+    }
+    return sum;
+}
+
+enum class FileKind {
+    Regular,
+    DeepNesting,
+    HugeFunction,
+    MacroSoup,
+    Generated,
+    Minified
+};
+
+std::string indent(size_t level) {
+    return std::string(level * 4, ' ');
+}
+
+// Condition with up to two boolean operators, each a fundamental increment
+std::string cpp_condition(Random& random, size_t level) {
+    std::string condition = "v" + std::to_string(level % 3) + " > " + std::to_string(random.upto(9));
+    for (size_t i = random.upto(2); i > 0; --i) {
+        condition += random.chance(0.5) ? " && " : " || ";
+        condition += "v" + std::to_string(random.upto(2)) + " < " + std::to_string(random.upto(99));
+    }
+    return condition;
+}
+
+void cpp_function(std::string& out, Random& random, const CorpusOptions& options, const std::string& name,
+                  size_t overload) {
+    // Conditions use v0 to v2; overloads add parameters after them
+    out += "int " + name + "(int v0";
+    for (size_t p = 1; p <= overload + 2; ++p) {
+        out += ", int v" + std::to_string(p);
+    }
+    out += ") {\n    int total = 0;\n";
+
+    size_t depth = random.upto(options.max_depth);
+    for (size_t level = 1; level <= depth; ++level) {
+        switch (random.upto(2)) {
+            case 0:
+                out += indent(level) + "for (int i" + std::to_string(level) + " = 0; i" + std::to_string(level) +
+                       " < v0; ++i" + std::to_string(level) + ") {\n";
+                break;
+            case 1:
+                out += indent(level) + "if (" + cpp_condition(random, level) + ") {\n";
+                break;
+            default:
+                out += indent(level) + "while (total < " + std::to_string(random.upto(999)) + ") {\n";
+                break;
+        }
+    }
+    out += indent(depth + 1) + "total += " + std::to_string(random.upto(9) + 1) + ";\n";
+    for (size_t level = depth; level > 0; --level) {
+        out += indent(level) + "}\n";
+    }
+
+    size_t chain = random.upto(options.else_if_chain);
+    if (chain > 0) {
+        out += "    if (v0 == 0) {\n        total += 1;\n    }";
+        for (size_t i = 1; i <= chain; ++i) {
+            out += " else if (v0 == " + std::to_string(i) + ") {\n        total += " + std::to_string(i + 1) +
+                   ";\n    }";
+        }
+        out += " else {\n        total -= 1;\n    }\n";
+    }
+    out += "    return total;\n}\n\n";
+}
+
+void python_function(std::string& out, Random& random, const CorpusOptions& options, const std::string& name,
+                     size_t base_indent) {
+    out += indent(base_indent) + "def " + name + "(v0, v1, v2):\n";
+    out += indent(base_indent + 1) + "total = 0\n";
+
+    size_t depth = random.upto(options.max_depth);
+    for (size_t level = 1; level <= depth; ++level) {
+        std::string condition = "v" + std::to_string(level % 3) + " > " + std::to_string(random.upto(9));
+        for (size_t i = random.upto(2); i > 0; --i) {
+            condition += random.chance(0.5) ? " and " : " or ";
+            condition += "v" + std::to_string(random.upto(2)) + " < " + std::to_string(random.upto(99));
+        }
+        switch (random.upto(2)) {
+            case 0:
+                out += indent(base_indent + level) + "for i" + std::to_string(level) + " in range(v0):\n";
+                break;
+            case 1:
+                out += indent(base_indent + level) + "if " + condition + ":\n";
+                break;
+            default:
+                out += indent(base_indent + level) + "while total < " + std::to_string(random.upto(999)) + ":\n";
+                break;
+        }
+    }
+    out += indent(base_indent + depth + 1) + "total += " + std::to_string(random.upto(9) + 1) + "\n";
+
+    size_t chain = random.upto(options.else_if_chain);
+    if (chain > 0) {
+        out += indent(base_indent + 1) + "if v0 == 0:\n" + indent(base_indent + 2) + "total += 1\n";
+        for (size_t i = 1; i <= chain; ++i) {
+            out += indent(base_indent + 1) + "elif v0 == " + std::to_string(i) + ":\n" + indent(base_indent + 2) +
+                   "total += " + std::to_string(i + 1) + "\n";
+        }
+        out += indent(base_indent + 1) + "else:\n" + indent(base_indent + 2) + "total -= 1\n";
+    }
+    out += indent(base_indent + 1) + "return total\n\n";
+}
+
+// Returns the number of functions written
+size_t regular_cpp(std::string& out, Random& random, const CorpusOptions& options, size_t functions) {
+    out += "#include <vector>\n\nnamespace corpus {\n\n";
+    size_t written = 0;
+    for (size_t f = 0; written < functions; ++f) {
+        std::string name = "function_" + std::to_string(f);
+        size_t overloads = std::min(random.upto(options.overloads > 0 ? options.overloads - 1 : 0) + 1,
+                                    functions - written);
+        for (size_t overload = 0; overload < overloads; ++overload) {
+            cpp_function(out, random, options, name, overload);
+        }
+        written += overloads;
+    }
+    out += "} // namespace corpus\n";
+    return written;
+}
+
+size_t regular_python(std::string& out, Random& random, const CorpusOptions& options, size_t functions) {
+    out += "import os\n\n\n";
+    size_t f = 0;
+    while (f < functions) {
+        // Every few functions go into a class as methods
+        if (random.chance(0.2) && functions - f >= 2) {
+            size_t methods = std::min<size_t>(random.upto(3) + 2, functions - f);
+            out += "class Handler" + std::to_string(f) + ":\n";
+            for (size_t m = 0; m < methods; ++m) {
+                python_function(out, random, options, "method_" + std::to_string(f++), 1);
+            }
+            out += "\n";
+        } else {
+            python_function(out, random, options, "function_" + std::to_string(f++), 0);
+        }
+    }
+    return functions;
+}
+
+void deep_nesting(std::string& out, bool python) {
+    constexpr size_t depth = 300;
+    if (python) {
+        out += "def deep(v0):\n";
+        for (size_t level = 1; level <= depth; ++level) {
+            out += indent(level) + "if v0 > " + std::to_string(level) + ":\n";
+        }
+        out += indent(depth + 1) + "return v0\n";
+        return;
+    }
+    out += "int deep(int v0) {\n";
+    for (size_t level = 1; level <= depth; ++level) {
+        out += indent(level) + "if (v0 > " + std::to_string(level) + ") {\n";
+    }
+    out += indent(depth + 1) + "return v0;\n";
+    for (size_t level = depth; level > 0; --level) {
+        out += indent(level) + "}\n";
+    }
+    out += "    return 0;\n}\n";
+}
+
+void huge_function(std::string& out, bool python) {
+    constexpr size_t statements = 20000;
+    out += python ? "def huge(v0):\n    total = 0\n" : "int huge(int v0) {\n    int total = 0;\n";
+    for (size_t i = 0; i < statements; ++i) {
+        out += python ? "    if v0 > " + std::to_string(i) + ":\n        total += 1\n"
+                      : "    if (v0 > " + std::to_string(i) + ") {\n        total += 1;\n    }\n";
+    }
+    out += python ? "    return total\n" : "    return total;\n}\n";
+}
+
+// Unknown macros that open and close scopes, which tree-sitter recovers
+// from with large ERROR nodes
+void macro_soup(std::string& out, Random& random, size_t functions) {
+    out += "#include \"framework.h\"\n\nBEGIN_NAMESPACE(corpus)\n\n";
+    for (size_t f = 0; f < functions; ++f) {
+        out += "DECLARE_HANDLER(Handler" + std::to_string(f) + ", kPriority" + std::to_string(random.upto(3)) +
+               ") {\n";
+        out += "    FOR_EACH(item, request.items()) {\n";
+        out += "        CHECK(item.valid()) << \"bad item \" << item;\n";
+        out += "        IF_ENABLED(kFeature" + std::to_string(random.upto(9)) + ")\n";
+        out += "            DISPATCH(item) WITH_RETRY(3) {\n                ++handled;\n            }\n";
+        out += "    END_FOR_EACH\n";
+        out += "}\nEND_HANDLER\n\n";
+    }
+    out += "END_NAMESPACE\n";
+}
+
+FileKind pick_kind(Random& random, const CorpusOptions& options) {
+    double roll = random.unit();
+    if (roll <= options.pathological_fraction) {
+        switch (random.upto(2)) {
+            case 0: return FileKind::DeepNesting;
+            case 1: return FileKind::HugeFunction;
+            default: return FileKind::MacroSoup;
+        }
+    }
+    if (roll <= options.pathological_fraction + options.generated_fraction) {
+        return random.chance(0.5) ? FileKind::Generated : FileKind::Minified;
+    }
+    return FileKind::Regular;
+}
+
+} // namespace
+
+CorpusSummary write_corpus(const std::filesystem::path& directory, const CorpusOptions& options) {
+    CorpusSummary summary;
+    std::string source;
+    for (size_t i = 0; i < options.files; ++i) {
+        // Each file has its own stream, so changing the file count leaves the
+        // other files unchanged
+        Random random(options.seed * 0x100000001b3 + i);
+        bool python = random.chance(options.python_fraction);
+        FileKind kind = pick_kind(random, options);
+
+        double scale = exponential(options.size_spread * random.normal());
+        auto functions = static_cast<size_t>(std::llround(static_cast<double>(options.functions_per_file) * scale));
+        functions = std::clamp<size_t>(functions, 1, std::max<size_t>(options.functions_per_file * 50, 1));
+
+        source.clear();
+        switch (kind) {
+            case FileKind::Regular:
+                summary.functions += python ? regular_python(source, random, options, functions)
+                                            : regular_cpp(source, random, options, functions);
+                break;
+            case FileKind::DeepNesting:
+                deep_nesting(source, python);
+                break;
+            case FileKind::HugeFunction:
+                huge_function(source, python);
+                break;
+            case FileKind::MacroSoup:
+                // Python has no macros; its stress case is the huge function
+                if (python) {
+                    huge_function(source, python);
+                } else {
+                    macro_soup(source, random, functions);
+                }
+                break;
+            case FileKind::Generated:
+                source += python ? "# @generated by catchy_corpus. DO NOT EDIT.\n\n"
+                                 : "// @generated by catchy_corpus. DO NOT EDIT.\n\n";
+                python ? regular_python(source, random, options, functions)
+                       : regular_cpp(source, random, options, functions);
+                break;
+            case FileKind::Minified:
+                // Python cannot be put on one line; minify C++ only
+                regular_cpp(source, random, options, functions);
+                std::replace(source.begin(), source.end(), '\n', ' ');
+                source.insert(0, "#include <vector>\n");
+                python = false;
+                break;
+        }
+        if (kind == FileKind::Generated || kind == FileKind::Minified) {
+            summary.generated_files++;
+        } else if (kind != FileKind::Regular) {
+            summary.pathological_files++;
+        }
+
+        auto subdirectory = directory / ("pkg_" + std::to_string(i % 16)) / ("mod_" + std::to_string(i / 16 % 16));
+        std::filesystem::create_directories(subdirectory);
+        auto path = subdirectory / ("file_" + std::to_string(i) + (python ? ".py" : ".cpp"));
+        std::ofstream output(path, std::ios::binary);
+        output << source;
+        if (!output) {
+            throw std::runtime_error("Failed to write " + path.string());
+        }
+        summary.files++;
+        summary.bytes += source.size();
+    }
+    return summary;
+}
+
+} // namespace catchy::bench
@@ -0,0 +1,52 @@
+#ifndef CATCHY_BENCH_CORPUS_HPP
+#define CATCHY_BENCH_CORPUS_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace catchy::bench {
+
+// Shape of a synthetic source tree. The same options and seed give the same
+// files on every platform: the generator uses its own random number generator
+// and distributions rather than the standard library's, whose output differs
+// between implementations.
+struct CorpusOptions {
+    uint64_t seed {1};
+    size_t files {100};
+    // Median functions per file; counts are log-normally distributed around
+    // it with this spread (sigma), so most files are small and a few large
+    size_t functions_per_file {20};
+    double size_spread {1.0};
+    // Control structure nesting per function, drawn from [0, max_depth]
+    size_t max_depth {4};
+    // Longest else-if (elif) chain; each function gets one of [0, else_if_chain]
+    size_t else_if_chain {3};
+    // Most overloads of one C++ function name
+    size_t overloads {2};
+    double python_fraction {0.25};
+    // Files built to stress the analyzer: extreme nesting, one enormous
+    // function, or macros tree-sitter cannot parse
+    double pathological_fraction {0.02};
+    // Files the sniffer should skip: @generated headers and minified lines
+    double generated_fraction {0.02};
+};
+
+struct CorpusSummary {
+    size_t files {0};
+    size_t bytes {0};
+    // Functions in regular files; pathological and generated ones not counted
+    size_t functions {0};
+    size_t pathological_files {0};
+    size_t generated_files {0};
+};
+
+// Writes the corpus below `directory`, spreading files over two levels of
+// subdirectories
+CorpusSummary write_corpus(const std::filesystem::path& directory, const CorpusOptions& options);
+
+} // namespace catchy::bench
+
+#endif // CATCHY_BENCH_CORPUS_HPP
@@ -0,0 +1,104 @@
+// Writes a deterministic synthetic corpus for scaling and stress runs.
+//
+//   catchy_corpus <output directory> [--files=N] [--seed=N] ...
+#include "corpus.hpp"
+#include <llvm/Support/CommandLine.h>
+#include <iostream>
+
+using namespace llvm;
+
+static cl::OptionCategory CorpusCategory("Corpus Options");
+
+static cl::opt<std::string> OutputDirectory(
+    cl::Positional,
+    cl::desc("<output directory>"),
+    cl::Required,
+    cl::cat(CorpusCategory));
+
+static cl::opt<unsigned long long> Seed(
+    "seed",
+    cl::desc("Random seed; the same seed and options give the same corpus (default: 1)"),
+    cl::init(1),
+    cl::cat(CorpusCategory));
+
+static cl::opt<unsigned> Files(
+    "files",
+    cl::desc("Number of files (default: 100)"),
+    cl::init(100),
+    cl::cat(CorpusCategory));
+
+static cl::opt<unsigned> FunctionsPerFile(
+    "functions",
+    cl::desc("Median functions per file (default: 20)"),
+    cl::init(20),
+    cl::cat(CorpusCategory));
+
+static cl::opt<double> SizeSpread(
+    "size-spread",
+    cl::desc("Spread of the log-normal file size distribution, 0 for equal sizes (default: 1.0)"),
+    cl::init(1.0),
+    cl::cat(CorpusCategory));
+
+static cl::opt<unsigned> MaxDepth(
+    "max-depth",
+    cl::desc("Deepest control structure nesting in a function (default: 4)"),
+    cl::init(4),
+    cl::cat(CorpusCategory));
+
+static cl::opt<unsigned> ElseIfChain(
+    "else-if",
+    cl::desc("Longest else-if chain in a function (default: 3)"),
+    cl::init(3),
+    cl::cat(CorpusCategory));
+
+static cl::opt<unsigned> Overloads(
+    "overloads",
+    cl::desc("Most overloads of one C++ function name (default: 2)"),
+    cl::init(2),
+    cl::cat(CorpusCategory));
+
+static cl::opt<double> PythonFraction(
+    "python-fraction",
+    cl::desc("Share of Python files (default: 0.25)"),
+    cl::init(0.25),
+    cl::cat(CorpusCategory));
+
+static cl::opt<double> PathologicalFraction(
+    "pathological-fraction",
+    cl::desc("Share of files with extreme nesting, one huge function or unparseable macros (default: 0.02)"),
+    cl::init(0.02),
+    cl::cat(CorpusCategory));
+
+static cl::opt<double> GeneratedFraction(
+    "generated-fraction",
+    cl::desc("Share of @generated and minified files (default: 0.02)"),
+    cl::init(0.02),
+    cl::cat(CorpusCategory));
+
+int main(int argc, char** argv) {
+    cl::HideUnrelatedOptions(CorpusCategory);
+    cl::ParseCommandLineOptions(argc, argv, "Catchy synthetic corpus generator\n");
+
+    catchy::bench::CorpusOptions options;
+    options.seed = Seed;
+    options.files = Files;
+    options.functions_per_file = FunctionsPerFile;
+    options.size_spread = SizeSpread;
+    options.max_depth = MaxDepth;
+    options.else_if_chain = ElseIfChain;
+    options.overloads = Overloads;
+    options.python_fraction = PythonFraction;
+    options.pathological_fraction = PathologicalFraction;
+    options.generated_fraction = GeneratedFraction;
+
+    try {
+        auto summary = catchy::bench::write_corpus(OutputDirectory.getValue(), options);
+        std::cout << "Wrote " << summary.files << " files (" << summary.bytes << " bytes, " << summary.functions
+                  << " functions, " << summary.pathological_files << " pathological, " << summary.generated_files
+                  << " generated) to " << OutputDirectory.getValue() << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "catchy_corpus: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
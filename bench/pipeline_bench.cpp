@@ -0,0 +1,240 @@
+// One benchmark per stage of analyzing a file, in pipeline order, followed by
+// whole directory runs. Each reports bytes/s and, where functions are
+// involved, functions/s; run catchy_bench_json to save them as JSON.
+#include "corpus.hpp"
+#include "synthetic_source.hpp"
+#include "temp_files.hpp"
+#include "analysis/analyzer.hpp"
+#include "complexity/cognitive_complexity.hpp"
+#include "parser/languages/cpp_parser.hpp"
+#include "parser/languages/python_parser.hpp"
+#include "parser/parser_factory.hpp"
+#include "utils/filesystem.hpp"
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+namespace {
+
+using catchy::analysis::Analyzer;
+using catchy::bench::write_temp_source;
+
+// Depth of the control structures in every generated function
+constexpr size_t nesting = 3;
+
+std::string make_source(size_t functions, bool python) {
+    return python ? catchy::bench::make_python_source(functions, nesting)
+                  : catchy::bench::make_cpp_source(functions, nesting);
+}
+
+const TSLanguage* grammar(bool python) {
+    return python ? tree_sitter_python() : tree_sitter_cpp();
+}
+
+std::unique_ptr<catchy::parser::ParserBase> make_parser(bool python) {
+    std::unique_ptr<catchy::parser::ParserBase> parser;
+    if (python) {
+        parser = std::make_unique<catchy::parser::languages::PythonParser>();
+    } else {
+        parser = std::make_unique<catchy::parser::languages::CppParser>();
+    }
+    parser->initialize();
+    return parser;
+}
+
+using TreePtr = std::unique_ptr<TSTree, void (*)(TSTree*)>;
+
+TreePtr parse(const std::string& source, bool python) {
+    std::unique_ptr<TSParser, void (*)(TSParser*)> parser{ts_parser_new(), ts_parser_delete};
+    ts_parser_set_language(parser.get(), grammar(python));
+    return TreePtr{ts_parser_parse_string(parser.get(), nullptr, source.c_str(),
+                                          static_cast<uint32_t>(source.size())),
+                   ts_tree_delete};
+}
+
+void set_rates(benchmark::State& state, size_t bytes, size_t functions) {
+    state.SetBytesProcessed(static_cast<int64_t>(bytes * state.iterations()));
+    if (functions > 0) {
+        state.counters["functions/s"] = benchmark::Counter(
+            static_cast<double>(functions * state.iterations()), benchmark::Counter::kIsRate);
+    }
+}
+
+void BM_ReadFileContent(benchmark::State& state) {
+    auto functions = static_cast<size_t>(state.range(0));
+    auto source = make_source(functions, false);
+    auto path = write_temp_source("read_" + std::to_string(functions) + ".cpp", source);
+
+    for (auto _ : state) {
+        auto content = catchy::utils::read_file_content(path);
+        benchmark::DoNotOptimize(content);
+    }
+
+    set_rates(state, source.size(), 0);
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_ReadFileContent)->Arg(100)->Arg(10000)->ArgName("functions");
+
+void BM_CreateParserForFile(benchmark::State& state) {
+    bool python = state.range(0) != 0;
+    // Constructing an analyzer registers the parsers
+    Analyzer analyzer;
+    std::string path = python ? "module.py" : "source.cpp";
+    auto& factory = catchy::parser::ParserFactory::instance();
+
+    for (auto _ : state) {
+        auto parser = factory.create_parser_for_file(path);
+        benchmark::DoNotOptimize(parser);
+    }
+}
+BENCHMARK(BM_CreateParserForFile)->Arg(0)->Arg(1)->ArgName("python");
+
+void BM_TreeSitterParse(benchmark::State& state) {
+    auto functions = static_cast<size_t>(state.range(0));
+    bool python = state.range(1) != 0;
+    auto source = make_source(functions, python);
+
+    for (auto _ : state) {
+        auto tree = parse(source, python);
+        benchmark::DoNotOptimize(tree);
+    }
+
+    set_rates(state, source.size(), functions);
+}
+BENCHMARK(BM_TreeSitterParse)
+    ->ArgsProduct({{100, 1000}, {0, 1}})
+    ->ArgNames({"functions", "python"})
+    ->Unit(benchmark::kMillisecond);
+
+// Parsing and extraction together, as parse_functions does on its own
+void BM_ParseFunctions(benchmark::State& state) {
+    auto functions = static_cast<size_t>(state.range(0));
+    bool python = state.range(1) != 0;
+    auto parser = make_parser(python);
+    catchy::parser::ParserContext context{make_source(functions, python), python ? "bench.py" : "bench.cpp"};
+
+    for (auto _ : state) {
+        auto found = parser->parse_functions(context);
+        benchmark::DoNotOptimize(found);
+    }
+
+    set_rates(state, context.file_content.size(), functions);
+}
+BENCHMARK(BM_ParseFunctions)
+    ->ArgsProduct({{100, 1000}, {0, 1}})
+    ->ArgNames({"functions", "python"})
+    ->Unit(benchmark::kMillisecond);
+
+// Extraction from a tree parsed once, as the analyzer does. This replaced
+// the per-function find_function_node search.
+void BM_FindFunctions(benchmark::State& state) {
+    auto functions = static_cast<size_t>(state.range(0));
+    bool python = state.range(1) != 0;
+    auto parser = make_parser(python);
+    auto source = make_source(functions, python);
+    auto tree = parse(source, python);
+    TSNode root = ts_tree_root_node(tree.get());
+
+    for (auto _ : state) {
+        auto found = parser->find_functions(root, source);
+        benchmark::DoNotOptimize(found);
+    }
+
+    set_rates(state, source.size(), functions);
+}
+BENCHMARK(BM_FindFunctions)
+    ->ArgsProduct({{100, 1000}, {0, 1}})
+    ->ArgNames({"functions", "python"})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_CognitiveComplexity(benchmark::State& state) {
+    auto functions = static_cast<size_t>(state.range(0));
+    bool python = state.range(1) != 0;
+    bool record_factors = state.range(2) != 0;
+    auto parser = make_parser(python);
+    auto source = make_source(functions, python);
+    auto tree = parse(source, python);
+    auto found = parser->find_functions(ts_tree_root_node(tree.get()), source);
+
+    catchy::complexity::CognitiveComplexity calculator;
+    calculator.set_record_factors(record_factors);
+    for (auto _ : state) {
+        for (const auto& function : found) {
+            auto result = calculator.calculate(function.node, source);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+
+    set_rates(state, source.size(), found.size());
+}
+BENCHMARK(BM_CognitiveComplexity)
+    ->ArgsProduct({{100, 1000}, {0, 1}, {0, 1}})
+    ->ArgNames({"functions", "python", "factors"})
+    ->Unit(benchmark::kMillisecond);
+
+// A recursive run over a tree of mixed C++ and Python files
+void BM_AnalyzeDirectory(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::warn);
+    auto files = static_cast<size_t>(state.range(0));
+    auto jobs = static_cast<size_t>(state.range(1));
+    constexpr size_t functions_per_file = 50;
+
+    catchy::bench::TempDirectory directory("directory_" + std::to_string(files));
+    size_t bytes = 0;
+    for (size_t i = 0; i < files; ++i) {
+        bool python = i % 4 == 3;
+        auto subdirectory = directory.path() / ("module_" + std::to_string(i % 16));
+        std::filesystem::create_directories(subdirectory);
+        auto source = make_source(functions_per_file, python);
+        bytes += source.size();
+        std::ofstream(subdirectory / ("file_" + std::to_string(i) + (python ? ".py" : ".cpp"))) << source;
+    }
+
+    Analyzer analyzer;
+    analyzer.set_jobs(jobs);
+    for (auto _ : state) {
+        auto results = analyzer.analyze_directory(directory.path().string(), true);
+        benchmark::DoNotOptimize(results);
+    }
+
+    set_rates(state, bytes, files * functions_per_file);
+    state.counters["files/s"] = benchmark::Counter(
+        static_cast<double>(files * state.iterations()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_AnalyzeDirectory)
+    ->ArgsProduct({{200}, {1, 4}})
+    ->ArgNames({"files", "jobs"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Scaling over generated corpora with the default mix of sizes, languages,
+// pathological and generated files
+void BM_CorpusScaling(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::err);
+    catchy::bench::CorpusOptions options;
+    options.files = static_cast<size_t>(state.range(0));
+    auto jobs = static_cast<size_t>(state.range(1));
+
+    catchy::bench::TempDirectory directory("corpus_" + std::to_string(options.files));
+    auto corpus = catchy::bench::write_corpus(directory.path(), options);
+
+    Analyzer analyzer;
+    analyzer.set_jobs(jobs);
+    for (auto _ : state) {
+        auto results = analyzer.analyze_directory(directory.path().string(), true);
+        benchmark::DoNotOptimize(results);
+    }
+
+    set_rates(state, corpus.bytes, corpus.functions);
+    state.counters["files/s"] = benchmark::Counter(
+        static_cast<double>(corpus.files * state.iterations()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_CorpusScaling)
+    ->ArgsProduct({{100, 400, 1600}, {1, 4}})
+    ->ArgNames({"files", "jobs"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
@@ -0,0 +1,58 @@
+#ifndef CATCHY_BENCH_SYNTHETIC_SOURCE_HPP
+#define CATCHY_BENCH_SYNTHETIC_SOURCE_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace catchy::bench {
+
+// C++ translation unit whose f-th function nests `depth_of(f)` control structures
+inline std::string make_cpp_source(size_t functions, const std::function<size_t(size_t)>& depth_of) {
+    std::string source = "#include <vector>\n\n";
+    for (size_t f = 0; f < functions; ++f) {
+        size_t depth = depth_of(f);
+        source += "int function_" + std::to_string(f) + "(const std::vector<int>& values) {\n";
+        source += "    int total = 0;\n";
+        std::string indent = "    ";
+        for (size_t d = 0; d < depth; ++d) {
+            source += indent + (d % 2 == 0 ? "for (int v : values) {\n" : "if (v > " + std::to_string(d) + ") {\n");
+            indent += "    ";
+        }
+        source += indent + "total += 1;\n";
+        for (size_t d = depth; d > 0; --d) {
+            indent.resize(indent.size() - 4);
+            source += indent + "}\n";
+        }
+        source += "    return total;\n}\n\n";
+    }
+    return source;
+}
+
+// C++ translation unit with `functions` functions nesting `depth` control structures each
+inline std::string make_cpp_source(size_t functions, size_t depth) {
+    return make_cpp_source(functions, [depth](size_t) { return depth; });
+}
+
+// Python module with the same shape as make_cpp_source
+inline std::string make_python_source(size_t functions, size_t depth) {
+    std::string source;
+    for (size_t f = 0; f < functions; ++f) {
+        source += "def function_" + std::to_string(f) + "(values):\n";
+        source += "    total = 0\n";
+        std::string indent = "    ";
+        for (size_t d = 0; d < depth; ++d) {
+            source += indent + (d % 2 == 0 ? "for v in values:\n" : "if v > " + std::to_string(d) + ":\n");
+            indent += "    ";
+        }
+        source += indent + "total += 1\n";
+        source += "    return total\n\n";
+    }
+    return source;
+}
+
+} // namespace catchy::bench
+
+#endif // CATCHY_BENCH_SYNTHETIC_SOURCE_HPP
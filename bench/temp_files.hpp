@@ -0,0 +1,45 @@
+#ifndef CATCHY_BENCH_TEMP_FILES_HPP
+#define CATCHY_BENCH_TEMP_FILES_HPP
+
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace catchy::bench {
+
+// Path of a file in the temporary directory that is unique to this process
+inline std::filesystem::path temp_path(const std::string& name) {
+    return std::filesystem::temp_directory_path() / ("catchy_bench_" + std::to_string(getpid()) + "_" + name);
+}
+
+inline std::string write_temp_source(const std::string& name, const std::string& content) {
+    auto path = temp_path(name);
+    std::ofstream(path) << content;
+    return path.string();
+}
+
+// Directory removed with everything in it when the benchmark is done
+class TempDirectory {
+public:
+    explicit TempDirectory(const std::string& name) : path_(temp_path(name)) {
+        std::filesystem::create_directories(path_);
+    }
+    ~TempDirectory() {
+        std::error_code error;
+        std::filesystem::remove_all(path_, error);
+    }
+    TempDirectory(const TempDirectory&) = delete;
+    TempDirectory& operator=(const TempDirectory&) = delete;
+
+    const std::filesystem::path& path() const { return path_; }
+
+private:
+    std::filesystem::path path_;
+};
+
+} // namespace catchy::bench
+
+#endif // CATCHY_BENCH_TEMP_FILES_HPP
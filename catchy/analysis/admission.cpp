@@ -0,0 +1,58 @@
+#include "admission.hpp"
+#include <algorithm>
+
+namespace catchy::analysis {
+
+namespace {
+
+// Parser stacks, the line index and other state independent of file size
+constexpr size_t per_file_overhead = 256 * 1024;
+
+// Syntax tree bytes per source byte. Rough upper figures: C++ produces more
+// and deeper nodes per byte than Python.
+size_t tree_factor(std::string_view language) {
+    if (language == "python") {
+        return 16;
+    }
+    return 20;
+}
+
+} // namespace
+
+size_t AdmissionControl::estimate(uint64_t file_size, std::string_view language) {
+    auto size = static_cast<size_t>(file_size);
+    // The source itself, plus its tree
+    return per_file_overhead + size + size * tree_factor(language);
+}
+
+AdmissionControl::Ticket AdmissionControl::admit(size_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto fits = [&] { return in_flight_ == 0 || in_flight_ + bytes <= max_bytes_; };
+    if (!fits()) {
+        delayed_++;
+        released_.wait(lock, fits);
+    }
+    in_flight_ += bytes;
+    peak_ = std::max(peak_, in_flight_);
+    return Ticket(*this, bytes);
+}
+
+size_t AdmissionControl::peak() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return peak_;
+}
+
+size_t AdmissionControl::delayed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return delayed_;
+}
+
+void AdmissionControl::release(size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_flight_ -= bytes;
+    }
+    released_.notify_all();
+}
+
+} // namespace catchy::analysis
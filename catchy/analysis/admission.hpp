@@ -0,0 +1,67 @@
+#ifndef CATCHY_ANALYSIS_ADMISSION_HPP
+#define CATCHY_ANALYSIS_ADMISSION_HPP
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+
+namespace catchy::analysis {
+
+// Bounds the estimated memory of the files being analyzed at once. A worker
+// waits before reading a file until its estimate fits under the budget next
+// to those in flight; a file over the whole budget is admitted alone, so no
+// file waits forever. Shared by the workers of a run.
+class AdmissionControl {
+public:
+    // Holds a file's share of the budget until destroyed
+    class Ticket {
+    public:
+        Ticket(AdmissionControl &control, size_t bytes) : control_(&control), bytes_(bytes) {}
+        Ticket(Ticket &&other) noexcept : control_(other.control_), bytes_(other.bytes_) { other.control_ = nullptr; }
+        Ticket(const Ticket &) = delete;
+        Ticket &operator=(const Ticket &) = delete;
+        Ticket &operator=(Ticket &&) = delete;
+        ~Ticket() {
+            if (control_) {
+                control_->release(bytes_);
+            }
+        }
+
+    private:
+        AdmissionControl *control_;
+        size_t bytes_;
+    };
+
+    explicit AdmissionControl(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+    // Rough peak memory of analyzing a file: its source, syntax tree and
+    // extraction state, which all grow with the file
+    static size_t estimate(uint64_t file_size, std::string_view language);
+
+    // Blocks until `bytes` fit
+    Ticket admit(size_t bytes);
+
+    size_t max_bytes() const { return max_bytes_; }
+    // Highest estimated total in flight so far
+    size_t peak() const;
+    // Files that had to wait for others to finish
+    size_t delayed() const;
+
+private:
+    void release(size_t bytes);
+
+    size_t max_bytes_;
+    mutable std::mutex mutex_;
+    std::condition_variable released_;
+    size_t in_flight_ {0};
+    size_t peak_ {0};
+    size_t delayed_ {0};
+};
+
+} // namespace catchy::analysis
+
+#endif // CATCHY_ANALYSIS_ADMISSION_HPP
@@ -1,23 +1,65 @@
 #include "analyzer.hpp"
 #include "parser/parser_factory.hpp"
+#include "complexity/keyword_bound.hpp"
 #include "parser/languages/cpp_parser.hpp"
 #include "parser/languages/python_parser.hpp"
 #include "utils/safe_conversions.hpp"
 #include "utils/filesystem.hpp"
 #include "utils/git.hpp"
+#include "utils/arena.hpp"
+#include "utils/sniff.hpp"
 #include <spdlog/spdlog.h>
 #include <llvm/Support/raw_ostream.h>
-#include <stack>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <thread>
 
 namespace catchy::analysis {
 
+namespace {
+
+// Bytes covered by ERROR nodes, visiting only subtrees that contain errors
+size_t error_bytes(TSNode root) {
+    size_t bytes = 0;
+    TSTreeCursor cursor = ts_tree_cursor_new(root);
+    bool visit = true;
+    while (true) {
+        TSNode node = ts_tree_cursor_current_node(&cursor);
+        if (visit && ts_node_has_error(node)) {
+            if (strcmp(ts_node_type(node), "ERROR") == 0) {
+                bytes += ts_node_end_byte(node) - ts_node_start_byte(node);
+            } else if (ts_tree_cursor_goto_first_child(&cursor)) {
+                continue;
+            }
+        }
+        if (ts_tree_cursor_goto_next_sibling(&cursor)) {
+            visit = true;
+        } else if (ts_tree_cursor_goto_parent(&cursor)) {
+            visit = false;
+        } else {
+            break;
+        }
+    }
+    ts_tree_cursor_delete(&cursor);
+    return bytes;
+}
+
+} // namespace
+
 Analyzer::Analyzer() 
-    : complexity_calculator_(std::make_unique<complexity::CognitiveComplexity>()),
+    : cancel_flag_(std::make_shared<std::atomic<size_t>>(0)),
+      complexity_calculator_(std::make_unique<complexity::CognitiveComplexity>()),
       parser_(ts_parser_new(), ts_parser_delete)
 {
     if (!parser_) {
         throw std::runtime_error("Failed to create tree-sitter parser");
     }
+    utils::install_tree_sitter_allocator();
+    // tree-sitter reads the flag through a plain size_t pointer
+    static_assert(std::atomic<size_t>::is_always_lock_free && sizeof(std::atomic<size_t>) == sizeof(size_t));
+    ts_parser_set_cancellation_flag(parser_.get(), reinterpret_cast<const size_t*>(cancel_flag_.get()));
 
     try {
         // Register parsers
@@ -37,47 +79,102 @@ Analyzer::Analyzer()
     }
 }
 
-std::vector<AnalysisResult> Analyzer::analyze_file(const std::string& file_path) {
+ResultStore Analyzer::analyze_file(const std::string& file_path) {
+    ResultStore results;
+    analyze_file(file_path, results);
+    return results;
+}
+
+void Analyzer::analyze_file(const std::string& file_path, ResultStore& results) {
     try {
         spdlog::info("Analyzing file: {}", file_path);
-        
+
+        // Held until the source and tree below are freed
+        std::optional<AdmissionControl::Ticket> ticket;
+        if (admission_) {
+            std::error_code error;
+            auto size = std::filesystem::file_size(file_path, error);
+            auto language = language_.empty() ? parser::ParserFactory::instance().language_for_file(file_path)
+                                              : language_;
+            ticket.emplace(admission_->admit(AdmissionControl::estimate(error ? 0 : size, language)));
+        }
+
         // Read file content
+        PhaseTimer reading(timed_stats(), Phase::Reading);
         std::string content = utils::read_file_content(file_path);
+        reading.stop();
         if (content.empty()) {
             spdlog::error("Empty file content for: {}", file_path);
-            return {};
+            return;
+        }
+        stats_.bytes_read += content.size();
+
+        PhaseTimer filtering(timed_stats(), Phase::Filtering);
+        if (sniff_content_) {
+            auto reason = utils::sniff_content(content);
+            if (reason != utils::SkipReason::None) {
+                spdlog::debug("Skipping {} file: {}", utils::describe(reason), file_path);
+                stats_.skip(reason);
+                return;
+            }
         }
         
         // Detect language
         std::string lang = language_.empty() ? detect_language(file_path) : language_;
         if (lang.empty()) {
             spdlog::error("Could not detect language for file: {}", file_path);
-            return {};
+            return;
         }
         spdlog::info("Detected language: {}", lang);
         
-        return analyze_content(content, file_path, lang);
+        size_t threshold = complexity_threshold_;
+        if (config_ && !threshold_overrides_config_) {
+            threshold = config_->resolve(file_path).threshold.value_or(threshold);
+        }
+
+        // With a threshold and no rollup, only functions reaching it are
+        // reported; a file whose keyword bound is below it has none
+        if (prefilter_ && threshold > 0 && !rollup_enabled_ && !keep_below_threshold_ &&
+            !complexity::may_reach_threshold(content, lang, threshold)) {
+            spdlog::debug("Skipping {}: no function can reach the threshold", file_path);
+            stats_.files_prefiltered++;
+            return;
+        }
+        filtering.stop();
+        if (mode_ == ScoringMode::Fast) {
+            estimate_content(content, file_path, lang, threshold, results);
+            return;
+        }
+        analyze_content(content, file_path, lang, threshold, results);
     } catch (const std::exception& e) {
         spdlog::error("Failed to analyze file {}: {}", file_path, e.what());
-        return {};
+        return;
     }
 }
 
-std::vector<AnalysisResult> Analyzer::analyze_directory(
+ResultStore Analyzer::analyze_directory(
     const std::string& directory_path,
     bool recursive
 ) {
-    std::vector<AnalysisResult> results;
+    ResultStore results;
     
     try {
-        auto files = utils::list_files(directory_path, recursive);
-        
-        for (const auto& file : files) {
-            if (should_analyze_file(file)) {
-                auto file_results = analyze_file(file);
-                results.insert(results.end(), file_results.begin(), file_results.end());
-            }
+        utils::WalkOptions options;
+        options.recursive = recursive;
+        options.extensions = parser::ParserFactory::instance().get_supported_extensions();
+        options.prune_default_directories = prune_directories_;
+        options.respect_ignore_files = respect_ignore_files_;
+        options.ignore_patterns = ignore_patterns_.get();
+        if (config_) {
+            options.skip_directory = [config = config_.get()](const std::string& path) {
+                return config->resolve(path).skip;
+            };
         }
+        options.threads = jobs_;
+        PhaseTimer listing(timed_stats(), Phase::Listing);
+        auto files = utils::walk_files(directory_path, options);
+        listing.stop();
+        results = analyze_files(files);
     } catch (const std::exception& e) {
         spdlog::error("Failed to analyze directory {}: {}", directory_path, e.what());
     }
@@ -85,24 +182,27 @@ std::vector<AnalysisResult> Analyzer::analyze_directory(
     return results;
 }
 
-std::vector<AnalysisResult> Analyzer::analyze_git_repository(
+ResultStore Analyzer::analyze_git_repository(
     const std::string& repository_path
 ) {
-    std::vector<AnalysisResult> results;
+    ResultStore results;
     
     try {
         if (!utils::is_git_repo(repository_path)) {
             throw std::runtime_error("Not a git repository");
         }
         
+        PhaseTimer listing(timed_stats(), Phase::Listing);
         auto files = utils::list_git_files(repository_path);
-        
-        for (const auto& file : files) {
-            if (should_analyze_file(file)) {
-                auto file_results = analyze_file(file);
-                results.insert(results.end(), file_results.begin(), file_results.end());
-            }
+        // Like the walker, leave the repository's own path out of --ignore
+        if (ignore_patterns_) {
+            size_t root_length = (std::filesystem::path(repository_path) / "").string().size();
+            std::erase_if(files, [&](const std::string& file) {
+                return ignore_patterns_->matches(file, root_length);
+            });
         }
+        listing.stop();
+        results = analyze_files(files);
     } catch (const std::exception& e) {
         spdlog::error("Failed to analyze git repository {}: {}", repository_path, e.what());
     }
@@ -110,12 +210,128 @@ std::vector<AnalysisResult> Analyzer::analyze_git_repository(
     return results;
 }
 
+ResultStore Analyzer::analyze_files(const std::vector<std::string>& files) {
+    PhaseTimer listing(timed_stats(), Phase::Listing);
+    std::vector<std::string> selected;
+    for (const auto& file : files) {
+        if (should_analyze_file(file)) {
+            selected.push_back(file);
+        }
+    }
+    listing.stop();
+
+    ResultStore results;
+    size_t jobs = std::min(jobs_, selected.size());
+    if (jobs <= 1) {
+        for (const auto& file : selected) {
+            if (cancelled()) {
+                break;
+            }
+            analyze_file(file, results);
+            if (spill_ && results.memory_usage() > spill_->memory_limit()) {
+                spill_->spill(results);
+            }
+        }
+        record_admission_stats();
+        return results;
+    }
+
+    // Workers own their parser state and rollup; they are created here since
+    // constructing an analyzer registers parsers with the shared factory
+    std::vector<std::unique_ptr<Analyzer>> workers;
+    for (size_t i = 0; i < jobs; ++i) {
+        workers.push_back(make_worker());
+    }
+
+    // Each worker appends to its own store; the rows of file i are
+    // stores[owner[i]][first_row[i], end_row[i]), stitched together in file
+    // order below so the output does not depend on scheduling
+    std::vector<ResultStore> stores(jobs);
+    std::vector<uint32_t> owner(selected.size());
+    std::vector<size_t> first_row(selected.size());
+    std::vector<size_t> end_row(selected.size());
+    std::atomic<size_t> next_file{0};
+    std::vector<std::thread> threads;
+    // Each worker gets an equal share of the memory limit
+    size_t spill_bytes = spill_ ? spill_->memory_limit() / jobs : 0;
+    for (size_t w = 0; w < jobs; ++w) {
+        threads.emplace_back([&, w, analyzer = workers[w].get()] {
+            auto& store = stores[w];
+            for (size_t i = next_file++; i < selected.size() && !cancelled(); i = next_file++) {
+                owner[i] = static_cast<uint32_t>(w);
+                first_row[i] = store.size();
+                analyzer->analyze_file(selected[i], store);
+                end_row[i] = store.size();
+                if (spill_ && store.memory_usage() > spill_bytes) {
+                    spill_->spill(store);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (auto& worker : workers) {
+        rollup_.merge(worker->rollup_);
+        stats_.merge(worker->stats_);
+    }
+    record_admission_stats();
+    size_t rows = 0;
+    for (const auto& store : stores) {
+        rows += store.size();
+    }
+    results.reserve(rows);
+    if (spill_ && spill_->runs() > 0) {
+        // Row ranges of spilled stores are stale, and reports merge the
+        // runs in key order anyway
+        for (const auto& store : stores) {
+            results.append(store);
+        }
+        return results;
+    }
+    for (size_t i = 0; i < selected.size(); ++i) {
+        results.append(stores[owner[i]], first_row[i], end_row[i]);
+    }
+    return results;
+}
+
+std::unique_ptr<Analyzer> Analyzer::make_worker() const {
+    auto worker = std::make_unique<Analyzer>();
+    worker->language_ = language_;
+    worker->complexity_threshold_ = complexity_threshold_;
+    worker->mode_ = mode_;
+    worker->limits_ = limits_;
+    worker->use_arena_ = use_arena_;
+    worker->spill_ = spill_;
+    worker->admission_ = admission_;
+    worker->cancel_flag_ = cancel_flag_;
+    ts_parser_set_cancellation_flag(worker->parser_.get(), reinterpret_cast<const size_t*>(cancel_flag_.get()));
+    worker->ignore_patterns_ = ignore_patterns_;
+    worker->config_ = config_;
+    worker->rollup_enabled_ = rollup_enabled_;
+    worker->aggregate_only_ = aggregate_only_;
+    worker->set_record_factors(record_factors_);
+    worker->explain_ = explain_;
+    worker->sniff_content_ = sniff_content_;
+    worker->prefilter_ = prefilter_;
+    worker->keep_below_threshold_ = keep_below_threshold_;
+    worker->threshold_overrides_config_ = threshold_overrides_config_;
+    worker->timing_ = timing_;
+    return worker;
+}
+
+void Analyzer::record_admission_stats() {
+    if (admission_) {
+        stats_.peak_inflight_bytes = admission_->peak();
+        stats_.files_delayed = admission_->delayed();
+    }
+}
+
 std::string Analyzer::detect_language(const std::string& file_path) const {
-    auto& factory = parser::ParserFactory::instance();
-    auto parser = factory.create_parser_for_file(file_path);
+    auto lang = parser::ParserFactory::instance().language_for_file(file_path);
     
-    if (parser) {
-        auto lang = parser->get_language_name();
+    if (!lang.empty()) {
         spdlog::debug("Language detected: {} for file: {}", lang, file_path);
         return lang;
     }
@@ -124,195 +340,280 @@ std::string Analyzer::detect_language(const std::string& file_path) const {
     return "";
 }
 
+// --ignore patterns were already applied when listing the files
 bool Analyzer::should_analyze_file(const std::string& file_path) const {
-    // Check if file matches any ignore patterns
-    for (const auto& pattern : ignore_patterns_) {
-        if (utils::matches_pattern(file_path, pattern)) {
-            return false;
-        }
-    }
-    
     // Check if we have a parser for this file type
-    return parser::ParserFactory::instance().create_parser_for_file(file_path) != nullptr;
+    auto language = parser::ParserFactory::instance().language_for_file(file_path);
+    if (language.empty()) {
+        return false;
+    }
+
+    if (config_) {
+        auto settings = config_->resolve(file_path);
+        return !settings.skip && settings.allows_language(language);
+    }
+    return true;
+}
+
+parser::ParserBase* Analyzer::function_finder(const std::string& language) {
+    auto [it, inserted] = function_finders_.try_emplace(language);
+    if (inserted) {
+        it->second = parser::ParserFactory::instance().create_parser(language);
+    }
+    return it->second.get();
+}
+
+const parser::FastScanner* Analyzer::fast_scanner(const std::string& language) {
+    auto [it, inserted] = fast_scanners_.try_emplace(language);
+    if (inserted) {
+        it->second = parser::ParserFactory::instance().create_fast_scanner(language);
+    }
+    return it->second.get();
 }
 
-std::vector<AnalysisResult> Analyzer::analyze_content(
+void Analyzer::analyze_content(
     const std::string& content,
     const std::string& file_path,
-    const std::string& language
+    const std::string& language,
+    size_t threshold,
+    ResultStore& results
 ) {
-    std::vector<AnalysisResult> results;
-    
+    // Rows of this file are dropped again if it blows the node budget
+    size_t first_row = results.size();
+
     try {
+        // Created before the arena scope since they outlive this file
+        auto finder = function_finder(language);
+        fast_scanner(language);
+
+        // The tree, a parser owning arena memory and the scratch containers
+        // all go away with the scope, which then resets the arena
+        std::optional<utils::ArenaScope> arena_scope;
+        std::unique_ptr<TSParser, void(*)(TSParser*)> file_parser{nullptr, ts_parser_delete};
+        TSParser* parser = parser_.get();
+        if (use_arena_) {
+            if (!arena_) {
+                arena_ = std::make_unique<utils::Arena>();
+            }
+            arena_scope.emplace(*arena_);
+            file_parser.reset(ts_parser_new());
+            parser = file_parser.get();
+            ts_parser_set_cancellation_flag(parser, reinterpret_cast<const size_t*>(cancel_flag_.get()));
+        }
+
         // Set up parser for the correct language
         if (language == "cpp") {
-            ts_parser_set_language(parser_.get(), tree_sitter_cpp());
+            ts_parser_set_language(parser, tree_sitter_cpp());
         } else if (language == "python") {
-            ts_parser_set_language(parser_.get(), tree_sitter_python());
+            ts_parser_set_language(parser, tree_sitter_python());
         } else {
             spdlog::error("Unsupported language: {}", language);
-            return results;
+            return;
         }
 
-        // Parse the entire file
-        tree_.reset(ts_parser_parse_string(
-            parser_.get(),
+        // Parse the entire file once; the language parser only walks the tree
+        PhaseTimer parsing(timed_stats(), Phase::Parsing);
+        ts_parser_set_timeout_micros(parser, limits_.timeout_micros);
+        std::unique_ptr<TSTree, void(*)(TSTree*)> tree{ts_parser_parse_string(
+            parser,
             nullptr,
             content.c_str(),
             static_cast<uint32_t>(content.length())
-        ));
+        ), ts_tree_delete};
+
+        if (!tree) {
+            // A halted parse is kept for resumption unless reset
+            ts_parser_reset(parser);
+            if (cancelled()) {
+                stats_.skip(utils::SkipReason::Cancelled);
+            } else if (limits_.timeout_micros > 0) {
+                spdlog::warn("Skipping {}: parsing took longer than {} ms", file_path, limits_.timeout_micros / 1000);
+                stats_.skip(utils::SkipReason::Timeout);
+            } else {
+                spdlog::error("Failed to parse content");
+            }
+            return;
+        }
 
-        if (!tree_) {
-            spdlog::error("Failed to parse content");
-            return results;
+        // Error recovery around unknown macros can swallow most of a file;
+        // its functions are then better estimated from tokens
+        TSNode root = ts_tree_root_node(tree.get());
+        if (limits_.max_error_percent < 100 && ts_node_has_error(root) && fast_scanner(language)) {
+            size_t errors = error_bytes(root);
+            if (errors * 100 > content.size() * limits_.max_error_percent) {
+                spdlog::info("Estimating {}: parse errors cover {}% of it", file_path, errors * 100 / content.size());
+                stats_.files_approximated++;
+                parsing.stop();
+                estimate_content(content, file_path, language, threshold, results);
+                return;
+            }
         }
+        parsing.stop();
 
         // Get functions
-        auto parser = parser::ParserFactory::instance().create_parser(language);
-        if (!parser || !parser->initialize()) {
+        if (!finder) {
             spdlog::error("Failed to initialize parser");
-            return results;
+            return;
         }
 
-        parser::ParserContext context{content, file_path};
-        auto functions = parser->parse_functions(context);
+        PhaseTimer extraction(timed_stats(), Phase::Extraction);
+        // Aggregates need no names
+        finder->set_extract_names(!aggregate_only_);
+        auto functions = finder->find_functions(root, content);
+        extraction.stop();
+        stats_.functions_found += functions.size();
         
         spdlog::debug("Found {} functions to analyze", functions.size());
-        
-        // Analyze each function
-        TSNode root_node = ts_tree_root_node(tree_.get());
+
+        PhaseTimer scoring(timed_stats(), Phase::Scoring);
+
+        // Only built once a function in this file needs explaining
+        std::optional<utils::LineIndex> line_index;
+        // Unreported functions need no exact score unless the rollup counts them
+        bool bound_functions = prefilter_ && threshold > 0 && !rollup_enabled_ && !keep_below_threshold_;
+        std::string_view source(content);
+        // Rollup entries are held back until the whole file is scored
+        std::pmr::vector<size_t> scores(utils::scratch_resource());
+        utils::InternedString interned_path(file_path);
+        utils::InternedString interned_language(language);
+        size_t functions_analyzed = 0;
+        complexity_calculator_->set_node_budget(limits_.max_nodes);
+        complexity_calculator_->set_max_depth(limits_.max_depth);
         
         for (const auto& func : functions) {
-            if (func.name.empty()) {
+            if ((func.name.empty() && !aggregate_only_) || ts_node_is_null(func.node)) {
+                continue;
+            }
+            TSNode function_node = func.node;
+
+            if (bound_functions) {
+                if (!complexity::may_reach_threshold(func.range.view(source), language, threshold)) {
+                    stats_.functions_prefiltered++;
+                    continue;
+                }
+            }
+
+            auto complexity_result = complexity_calculator_->calculate(function_node, content);
+            stats_.syntax_nodes += complexity_result.nodes_visited;
+            if (complexity_result.truncated) {
+                spdlog::warn("Skipping {}: syntax tree exceeds the node budget ({} nodes, depth {})", file_path,
+                             limits_.max_nodes, limits_.max_depth);
+                stats_.skip(utils::SkipReason::NodeLimit);
+                results.truncate(first_row);
+                return;
+            }
+            size_t complexity = complexity_result.total_complexity;
+            functions_analyzed++;
+            bool over_threshold = complexity >= threshold;
+            if (rollup_enabled_) {
+                scores.push_back(complexity);
+            }
+
+            // Only functions that are reported, or snapshotted, get a result
+            // record
+            if (aggregate_only_ || (!over_threshold && !keep_below_threshold_)) {
                 continue;
             }
 
             AnalysisResult result;
-            result.file_path = file_path;
-            result.language = language;
+            result.file_path = interned_path;
+            result.language = interned_language;
             result.function_name = func.name;
             result.start_line = func.start_line;
             result.end_line = func.end_line;
+            result.complexity = complexity;
+            result.factors = std::move(complexity_result.factors);
+            result.grammar = complexity_result.language;
+            result.below_threshold = !over_threshold;
+            if (explain_ && over_threshold) {
+                explain_result(result, function_node, content, line_index);
+            }
+            results.append(std::move(result));
+        }
 
-            // Find function node in the parsed tree
-            TSNode function_node = find_function_node(root_node, func.name, content);
-            
-            if (!ts_node_is_null(function_node)) {
-                auto complexity_result = complexity_calculator_->calculate(function_node, content);
-                result.complexity = complexity_result.total_complexity;
-                result.factors = std::move(complexity_result.factors);
-                
-                if (result.complexity >= complexity_threshold_) {
-                    results.push_back(std::move(result));
-                }
-            } else {
-                spdlog::debug("Could not find node for function: {}", func.name);
+        stats_.files_analyzed++;
+        stats_.functions_analyzed += functions_analyzed;
+        if (rollup_enabled_) {
+            PathTrie::NodeId rollup_file = rollup_.insert_file(file_path);
+            for (size_t complexity : scores) {
+                rollup_.record(rollup_file, complexity, complexity >= threshold);
             }
         }
     } catch (const std::exception& e) {
         spdlog::error("Error in analyze_content: {}", e.what());
     }
-    
-    return results;
 }
 
-TSNode Analyzer::find_function_node(TSNode node, const std::string& function_name, const std::string& source) {
-    if (ts_node_is_null(node)) {
-        return node;
+void Analyzer::estimate_content(
+    const std::string& content,
+    const std::string& file_path,
+    const std::string& language,
+    size_t threshold,
+    ResultStore& results
+) {
+    auto scanner = fast_scanner(language);
+    if (!scanner) {
+        spdlog::error("No fast scanner for language: {}", language);
+        return;
     }
 
-    const char* type = ts_node_type(node);
-    
-    // Handle Python functions (including decorated and nested ones)
-    if (strcmp(type, "function_definition") == 0 || 
-        strcmp(type, "decorated_definition") == 0) {
-        
-        TSNode actual_func_node = node;
-        if (strcmp(type, "decorated_definition") == 0) {
-            actual_func_node = ts_node_child_by_field_name(node, "definition", strlen("definition"));
-            if (ts_node_is_null(actual_func_node)) {
-                return TSNode{};
-            }
-        }
+    PhaseTimer scoring(timed_stats(), Phase::Scoring);
+    auto functions = scanner->scan(content);
+    spdlog::debug("Found {} functions to estimate", functions.size());
+    stats_.files_analyzed++;
+    stats_.functions_found += functions.size();
 
-        TSNode name_node = ts_node_child_by_field_name(actual_func_node, "name", strlen("name"));
-        if (!ts_node_is_null(name_node)) {
-            std::string current_name = extract_function_name(name_node, source);
-            
-            // Handle nested functions by building the full name
-            std::string full_name = current_name;
-            TSNode parent = ts_node_parent(actual_func_node);
-            
-            while (!ts_node_is_null(parent)) {
-                if (strcmp(ts_node_type(parent), "function_definition") == 0) {
-                    TSNode parent_name = ts_node_child_by_field_name(parent, "name", strlen("name"));
-                    if (!ts_node_is_null(parent_name)) {
-                        std::string parent_name_str = extract_function_name(parent_name, source);
-                        full_name = parent_name_str + "." + full_name;
-                    }
-                }
-                parent = ts_node_parent(parent);
-            }
-            
-            if (full_name == function_name) {
-                return actual_func_node;
-            }
+    PathTrie::NodeId rollup_file = rollup_enabled_ ? rollup_.insert_file(file_path) : PathTrie::root_id;
+    utils::InternedString interned_path(file_path);
+    utils::InternedString interned_language(language);
+    for (auto& func : functions) {
+        stats_.functions_analyzed++;
+        bool over_threshold = func.complexity >= threshold;
+        if (rollup_enabled_) {
+            rollup_.record(rollup_file, func.complexity, over_threshold);
         }
-    }
-    
-    // Handle C++ functions
-    if (strcmp(type, "function_definition") == 0) {
-        TSNode declarator = ts_node_child_by_field_name(node, "declarator", strlen("declarator"));
-        if (!ts_node_is_null(declarator)) {
-            auto cpp_parser = std::make_unique<parser::languages::CppParser>();
-            TSNode name_node = cpp_parser->find_function_name(declarator);
-            
-            if (!ts_node_is_null(name_node)) {
-                std::string current_name = extract_function_name(name_node, source);
-                if (current_name == function_name) {
-                    return node;
-                }
-            }
+        if (aggregate_only_ || (!over_threshold && !keep_below_threshold_)) {
+            continue;
         }
-    }
 
-    // Recursively search children
-    uint32_t child_count = ts_node_child_count(node);
-    for (uint32_t i = 0; i < child_count; i++) {
-        TSNode result = find_function_node(ts_node_child(node, i), function_name, source);
-        if (!ts_node_is_null(result)) {
-            return result;
-        }
+        AnalysisResult result;
+        result.file_path = interned_path;
+        result.language = interned_language;
+        result.function_name = std::move(func.name);
+        result.start_line = func.start_line;
+        result.end_line = func.end_line;
+        result.complexity = func.complexity;
+        result.approximate = true;
+        result.below_threshold = !over_threshold;
+        results.append(std::move(result));
     }
-
-    return TSNode{};
 }
 
-std::string Analyzer::extract_function_name(TSNode node, const std::string& source) {
-    // Find the identifier node
-    std::stack<TSNode> nodes;
-    nodes.push(node);
-    
-    while (!nodes.empty()) {
-        TSNode current = nodes.top();
-        nodes.pop();
-        
-        if (strcmp(ts_node_type(current), "identifier") == 0) {
-            uint32_t start = ts_node_start_byte(current);
-            uint32_t end = ts_node_end_byte(current);
-            if (start < source.length() && end <= source.length()) {
-                return source.substr(start, end - start);
-            }
-        }
-        
-        uint32_t child_count = ts_node_child_count(current);
-        for (uint32_t i = 0; i < child_count; i++) {
-            nodes.push(ts_node_child(current, i));
-        }
+void Analyzer::explain_result(
+    AnalysisResult& result,
+    TSNode function_node,
+    const std::string& content,
+    std::optional<utils::LineIndex>& line_index
+) {
+    // Functions are scored in counters-only mode; rescore the few that
+    // failed the gate with recording enabled
+    if (!record_factors_) {
+        // The function already fit the node budget; rescoring it is free
+        size_t nodes_left = complexity_calculator_->nodes_left();
+        complexity_calculator_->set_node_budget(0);
+        complexity_calculator_->set_record_factors(true);
+        result.factors = complexity_calculator_->calculate(function_node, content).factors;
+        complexity_calculator_->set_record_factors(false);
+        complexity_calculator_->set_nodes_left(nodes_left);
     }
-    
-    return "";
-}
 
+    if (!line_index) {
+        line_index.emplace(content);
+    }
+    result.snippets.reserve(result.factors.size());
+    for (const auto& factor : result.factors) {
+        result.snippets.emplace_back(utils::trim(line_index->line(factor.line_number)));
+    }
+}
 
 } // namespace catchy::analysis
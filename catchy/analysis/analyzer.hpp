@@ -6,24 +6,46 @@
 
 #include "parser/parser_factory.hpp"
 #include "complexity/cognitive_complexity.hpp"
+#include "analysis/admission.hpp"
+#include "analysis/project_config.hpp"
+#include "analysis/result_store.hpp"
+#include "analysis/rollup.hpp"
+#include "analysis/spill.hpp"
+#include "analysis/stats.hpp"
+#include "utils/arena.hpp"
+#include "utils/ignore.hpp"
+#include "utils/intern.hpp"
+#include "utils/line_index.hpp"
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
+#include <optional>
+#include <unordered_map>
 #include <tree_sitter/api.h>
 
 namespace catchy::analysis {
 
-struct AnalysisResult {
-    std::string file_path;
-    std::string language;
-    std::string function_name;
-    size_t start_line;
-    size_t end_line;
-    size_t complexity;
-    std::vector<complexity::ComplexityFactor> factors;
+// How functions are scored
+enum class ScoringMode {
+    // Parse with tree-sitter and run CognitiveComplexity
+    Exact,
+    // Estimate with the language's FastScanner; no factors are recorded
+    Fast
+};
 
-    // Serialize to TOML
-    std::string to_toml() const;
+// Per-file budgets; zero disables a limit
+struct ParseLimits {
+    // Time tree-sitter may spend parsing one file
+    uint64_t timeout_micros {0};
+    // Syntax nodes the scoring walk may visit in one file
+    size_t max_nodes {0};
+    // Deepest node below a function body the scoring walk descends to
+    size_t max_depth {0};
+    // Share of the file's bytes inside ERROR nodes above which the file is
+    // estimated by its fast scanner instead; 100 never falls back
+    size_t max_error_percent {100};
 };
 
 class Analyzer {
@@ -32,33 +54,133 @@ public:
     ~Analyzer() = default;
 
     // Analysis methods
-    std::vector<AnalysisResult> analyze_file(const std::string &file_path);
-    std::vector<AnalysisResult> analyze_directory(const std::string &directory_path, bool recursive = false);
-    std::vector<AnalysisResult> analyze_git_repository(const std::string &repository_path);
+    ResultStore analyze_file(const std::string &file_path);
+    ResultStore analyze_directory(const std::string &directory_path, bool recursive = false);
+    ResultStore analyze_git_repository(const std::string &repository_path);
 
     // Configuration
     void set_language(const std::string &language) { language_ = language; }
     void set_complexity_threshold(size_t threshold) { complexity_threshold_ = threshold; }
-    void set_ignore_patterns(const std::vector<std::string> &patterns) { ignore_patterns_ = patterns; }
+    void set_mode(ScoringMode mode) { mode_ = mode; }
+    // Files over a budget are skipped and counted in stats()
+    void set_limits(const ParseLimits &limits) { limits_ = limits; }
+    // Parse each file with a fresh parser whose memory, like the tree's,
+    // comes from a per-analyzer arena reset after the file
+    void set_use_arena(bool enabled) { use_arena_ = enabled; }
+    // Keep about this many bytes of results in memory when analyzing several
+    // files and spill the rest to sorted run files; zero keeps everything
+    void set_memory_limit(size_t bytes) { spill_ = bytes ? std::make_shared<ResultSpill>(bytes) : nullptr; }
+    // Only start on a file while the estimated memory of the files in flight
+    // stays under this many bytes; zero admits every file at once
+    void set_max_inflight_bytes(size_t bytes) {
+        admission_ = bytes ? std::make_shared<AdmissionControl>(bytes) : nullptr;
+    }
+    // Glob patterns of paths to skip, see utils::IgnorePatterns
+    void set_ignore_patterns(const std::vector<std::string> &patterns) {
+        ignore_patterns_ = std::make_shared<const utils::IgnorePatterns>(patterns);
+    }
+    // Per-path thresholds, languages and skips; the threshold set above
+    // applies where the config sets none
+    void set_project_config(std::shared_ptr<const ProjectConfig> config) { config_ = std::move(config); }
+    // Apply the threshold set above everywhere, ignoring per-path thresholds,
+    // as when it was given on the command line
+    void set_threshold_overrides_config(bool enabled) { threshold_overrides_config_ = enabled; }
+    void set_jobs(size_t jobs) { jobs_ = jobs; }
+    // Skip vendored and build directories when walking a directory
+    void set_prune_directories(bool prune) { prune_directories_ = prune; }
+    // Skip paths excluded by .gitignore, .git/info/exclude and .catchyignore
+    void set_respect_ignore_files(bool respect) { respect_ignore_files_ = respect; }
+    // Keep the individual complexity increments of every reported function
+    void set_record_factors(bool record) {
+        record_factors_ = record;
+        complexity_calculator_->set_record_factors(record);
+    }
+    // Record the factors and source lines of every function over the threshold
+    void set_explain(bool explain) { explain_ = explain; }
+    // Skip binary, generated and minified files after reading them
+    void set_sniff_content(bool enabled) { sniff_content_ = enabled; }
+    // Skip parsing files, and scoring functions, whose keyword count proves
+    // they cannot reach the threshold
+    void set_prefilter(bool enabled) { prefilter_ = enabled; }
+    void set_rollup_enabled(bool enabled) { rollup_enabled_ = enabled; }
+    // Also return every scored function under the threshold, flagged
+    // below_threshold(), so a snapshot can tell an improvement from a
+    // removal; the prefilter is bypassed since it skips scoring them
+    void set_keep_below_threshold(bool enabled) { keep_below_threshold_ = enabled; }
+    // Only feed the rollup; no per-function results are returned
+    void set_aggregate_only(bool enabled) {
+        aggregate_only_ = enabled;
+        rollup_enabled_ = rollup_enabled_ || enabled;
+    }
+    // Time each phase of the run in stats()
+    void set_timing(bool enabled) { timing_ = enabled; }
+
+    // Stops parsing in every worker and leaves the remaining files
+    // unanalyzed. Only stores to an atomic, so safe in a signal handler.
+    void cancel() { cancel_flag_->store(1, std::memory_order_relaxed); }
+    bool cancelled() const { return cancel_flag_->load(std::memory_order_relaxed) != 0; }
+    std::atomic<size_t> *cancellation_flag() const { return cancel_flag_.get(); }
+
+    // Per-directory totals of every analyzed function, including those under the threshold
+    PathTrie &rollup() { return rollup_; }
+    const AnalysisStats &stats() const { return stats_; }
+    // Results that did not fit the memory limit; null without one. Reports
+    // merge them with the returned store.
+    const ResultSpill *spill() const { return spill_.get(); }
 
 private:
-    std::vector<AnalysisResult> analyze_content(const std::string &content, const std::string &file_path, const std::string &language);
+    ResultStore analyze_files(const std::vector<std::string> &files);
+    std::unique_ptr<Analyzer> make_worker() const;
+    void record_admission_stats();
+    // Append the file's reported functions to `results`
+    void analyze_file(const std::string &file_path, ResultStore &results);
+    void analyze_content(const std::string &content, const std::string &file_path, const std::string &language,
+                         size_t threshold, ResultStore &results);
+    void estimate_content(const std::string &content, const std::string &file_path, const std::string &language,
+                          size_t threshold, ResultStore &results);
+    void explain_result(AnalysisResult &result, TSNode function_node, const std::string &content,
+                        std::optional<utils::LineIndex> &line_index);
     bool should_analyze_file(const std::string &file_path) const;
     std::string detect_language(const std::string &file_path) const;
-    
-    // Tree-sitter helper functions
-    TSNode find_function_node(TSNode node, const std::string& function_name, const std::string& source);
-    TSNode find_nested_function(TSNode body_node, const std::string& function_name, const std::string& source);
-    TSNode find_cpp_function_name(TSNode declarator);
-    std::string extract_function_name(TSNode node, const std::string& source);
+    parser::ParserBase *function_finder(const std::string &language);
+    const parser::FastScanner *fast_scanner(const std::string &language);
+    // Null unless timing, which turns PhaseTimer into a no-op
+    AnalysisStats *timed_stats() { return timing_ ? &stats_ : nullptr; }
 
     std::string language_;
     size_t complexity_threshold_ {0};
-    std::vector<std::string> ignore_patterns_;
+    ScoringMode mode_ {ScoringMode::Exact};
+    ParseLimits limits_;
+    bool use_arena_ {true};
+    std::unique_ptr<utils::Arena> arena_;
+    // Shared with the workers, which spill their own stores
+    std::shared_ptr<ResultSpill> spill_;
+    std::shared_ptr<AdmissionControl> admission_;
+    // Shared with the workers; tree-sitter polls it while parsing
+    std::shared_ptr<std::atomic<size_t>> cancel_flag_;
+    // Compiled once and shared with the workers
+    std::shared_ptr<const utils::IgnorePatterns> ignore_patterns_;
+    std::shared_ptr<const ProjectConfig> config_;
+    size_t jobs_ {1};
+    bool prune_directories_ {true};
+    bool respect_ignore_files_ {true};
+    bool rollup_enabled_ {false};
+    bool aggregate_only_ {false};
+    bool record_factors_ {false};
+    bool explain_ {false};
+    bool sniff_content_ {true};
+    bool prefilter_ {true};
+    bool keep_below_threshold_ {false};
+    bool threshold_overrides_config_ {false};
+    bool timing_ {false};
+    PathTrie rollup_;
+    AnalysisStats stats_;
     std::unique_ptr<complexity::CognitiveComplexity> complexity_calculator_;
+    // Created on first use per language; null for languages without one
+    std::unordered_map<std::string, std::unique_ptr<parser::FastScanner>> fast_scanners_;
+    std::unordered_map<std::string, std::unique_ptr<parser::ParserBase>> function_finders_;
 
     std::unique_ptr<TSParser, void(*)(TSParser*)> parser_{nullptr, ts_parser_delete};
-    std::unique_ptr<TSTree, void(*)(TSTree*)> tree_{nullptr, ts_tree_delete};
 };
 
 } // namespace catchy::analysis
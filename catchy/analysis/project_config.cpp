@@ -0,0 +1,325 @@
+#include "project_config.hpp"
+#include "utils/filesystem.hpp"
+#include "utils/toml.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace catchy::analysis {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool is_glob(std::string_view component) {
+    return component.find_first_of("*?[\\") != std::string_view::npos;
+}
+
+class EntryReader {
+public:
+    explicit EntryReader(const std::string& path) : path_(path) {}
+
+    [[noreturn]] void fail(const utils::TomlEntry& entry, const std::string& message) const {
+        throw std::runtime_error(path_ + ":" + std::to_string(entry.line) + ": " + message);
+    }
+
+    template <typename T>
+    const T& get(const utils::TomlEntry& entry, const char* expected) const {
+        const T* value = std::get_if<T>(&entry.value);
+        if (!value) {
+            fail(entry, "'" + entry.key + "' must be " + expected + ", not " +
+                        utils::toml_type_name(entry.value));
+        }
+        return *value;
+    }
+
+    size_t count(const utils::TomlEntry& entry) const {
+        int64_t value = get<int64_t>(entry, "an integer");
+        if (value < 0) {
+            fail(entry, "'" + entry.key + "' must not be negative");
+        }
+        return static_cast<size_t>(value);
+    }
+
+    bool flag(const utils::TomlEntry& entry) const { return get<bool>(entry, "a boolean"); }
+    const std::string& string(const utils::TomlEntry& entry) const { return get<std::string>(entry, "a string"); }
+    const std::vector<std::string>& strings(const utils::TomlEntry& entry) const {
+        return get<std::vector<std::string>>(entry, "an array of strings");
+    }
+
+private:
+    const std::string& path_;
+};
+
+} // namespace
+
+bool PathSettings::allows_language(const std::string& language) const {
+    return !languages || std::find(languages->begin(), languages->end(), language) != languages->end();
+}
+
+ProjectConfig ProjectConfig::load(const std::string& path) {
+    return parse(utils::read_file_content(path), path);
+}
+
+ProjectConfig ProjectConfig::parse(std::string_view text, const std::string& path) {
+    ProjectConfig config;
+    config.path_ = path;
+    config.working_directory_ = fs::current_path();
+    config.root_ = fs::absolute(fs::path(path)).lexically_normal().parent_path();
+    config.nodes_.emplace_back();
+
+    EntryReader reader(path);
+    for (const auto& table : utils::parse_toml(text, path)) {
+        if (table.name.empty()) {
+            for (const auto& entry : table.entries) {
+                if (entry.key == "threshold") {
+                    config.threshold_ = reader.count(entry);
+                } else if (entry.key == "languages") {
+                    config.languages_ = reader.strings(entry);
+                } else if (entry.key == "ignore") {
+                    config.ignores_ = std::make_shared<const utils::IgnorePatterns>(reader.strings(entry));
+                } else {
+                    reader.fail(entry, "unknown key '" + entry.key + "'");
+                }
+            }
+        } else if (table.name == "output" && !table.is_array_element) {
+            auto& output = config.output_;
+            for (const auto& entry : table.entries) {
+                if (entry.key == "rollup") {
+                    output.rollup = reader.flag(entry);
+                } else if (entry.key == "depth") {
+                    output.depth = reader.count(entry);
+                } else if (entry.key == "aggregate_only") {
+                    output.aggregate_only = reader.flag(entry);
+                } else if (entry.key == "explain") {
+                    output.explain = reader.flag(entry);
+                } else if (entry.key == "snapshot") {
+                    output.snapshot = reader.string(entry);
+                } else {
+                    reader.fail(entry, "unknown key '" + entry.key + "' in [output]");
+                }
+            }
+        } else if (table.name == "limits" && !table.is_array_element) {
+            auto& limits = config.limits_;
+            for (const auto& entry : table.entries) {
+                if (entry.key == "parse_timeout_ms") {
+                    limits.parse_timeout_ms = reader.count(entry);
+                } else if (entry.key == "max_nodes") {
+                    limits.max_nodes = reader.count(entry);
+                } else if (entry.key == "max_depth") {
+                    limits.max_depth = reader.count(entry);
+                } else if (entry.key == "max_error_percent") {
+                    limits.max_error_percent = reader.count(entry);
+                } else if (entry.key == "memory_limit_mb") {
+                    limits.memory_limit_mb = reader.count(entry);
+                } else if (entry.key == "max_inflight_bytes") {
+                    limits.max_inflight_bytes = reader.count(entry);
+                } else {
+                    reader.fail(entry, "unknown key '" + entry.key + "' in [limits]");
+                }
+            }
+        } else if (table.name == "path" && table.is_array_element) {
+            Section section;
+            std::optional<std::string> pattern;
+            for (const auto& entry : table.entries) {
+                if (entry.key == "match") {
+                    pattern = reader.string(entry);
+                } else if (entry.key == "threshold") {
+                    section.threshold = reader.count(entry);
+                } else if (entry.key == "languages") {
+                    section.languages = reader.strings(entry);
+                } else if (entry.key == "skip") {
+                    section.skip = reader.flag(entry);
+                } else {
+                    reader.fail(entry, "unknown key '" + entry.key + "' in [[path]]");
+                }
+            }
+            if (!pattern) {
+                throw std::runtime_error(path + ":" + std::to_string(table.line) +
+                                         ": [[path]] needs a 'match' pattern");
+            }
+            config.add_section(*pattern, std::move(section));
+        } else {
+            throw std::runtime_error(path + ":" + std::to_string(table.line) +
+                                     ": unknown table '" + table.name + "'");
+        }
+    }
+    return config;
+}
+
+std::optional<std::string> ProjectConfig::find(const std::string& start) {
+    std::error_code error;
+    fs::path directory = fs::absolute(start, error).lexically_normal();
+    if (error) {
+        return std::nullopt;
+    }
+    if (!fs::is_directory(directory, error)) {
+        directory = directory.parent_path();
+    }
+    if (!directory.has_filename()) {
+        directory = directory.parent_path();
+    }
+
+    while (true) {
+        fs::path candidate = directory / file_name;
+        if (fs::is_regular_file(candidate, error)) {
+            return candidate.string();
+        }
+        if (fs::exists(directory / ".git", error) || directory == directory.parent_path()) {
+            return std::nullopt;
+        }
+        directory = directory.parent_path();
+    }
+}
+
+void ProjectConfig::add_section(std::string_view pattern, Section section) {
+    if (pattern.substr(0, 2) == "./") {
+        pattern.remove_prefix(2);
+    }
+    NodeId node = root_id;
+    size_t pos = 0;
+    while (pos < pattern.size()) {
+        size_t end = pattern.find('/', pos);
+        if (end == std::string_view::npos) {
+            end = pattern.size();
+        }
+        auto component = pattern.substr(pos, end - pos);
+        if (!component.empty() && component != ".") {
+            node = child(node, component);
+        }
+        pos = end + 1;
+    }
+    nodes_[node].sections.push_back(static_cast<uint32_t>(sections_.size()));
+    sections_.push_back(std::move(section));
+}
+
+ProjectConfig::NodeId ProjectConfig::child(NodeId parent, std::string_view component) {
+    auto next = static_cast<NodeId>(nodes_.size());
+    if (component == "**") {
+        if (nodes_[parent].globstar != no_node) {
+            return nodes_[parent].globstar;
+        }
+        nodes_[parent].globstar = next;
+        nodes_.emplace_back().is_globstar = true;
+        return next;
+    }
+    if (is_glob(component)) {
+        for (const auto& [glob, id] : nodes_[parent].patterns) {
+            if (glob.pattern() == component) {
+                return id;
+            }
+        }
+        nodes_[parent].patterns.emplace_back(utils::Glob(component), next);
+    } else {
+        auto [it, inserted] = nodes_[parent].literals.try_emplace(std::string(component), next);
+        if (!inserted) {
+            return it->second;
+        }
+    }
+    nodes_.emplace_back();
+    return next;
+}
+
+// Add the "**" children of `nodes`, which also match zero components
+void ProjectConfig::expand(std::vector<NodeId>& nodes) const {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes_[nodes[i]].globstar != no_node) {
+            nodes.push_back(nodes_[nodes[i]].globstar);
+        }
+    }
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+}
+
+std::optional<std::string> ProjectConfig::relative_path(std::string_view path) const {
+    fs::path absolute(path);
+    if (absolute.is_relative()) {
+        absolute = working_directory_ / absolute;
+    }
+    std::string relative = absolute.lexically_normal().lexically_relative(root_).generic_string();
+    if (relative.empty() || relative == ".." || relative.compare(0, 3, "../") == 0) {
+        return std::nullopt;
+    }
+    if (relative == ".") {
+        relative.clear();
+    }
+    return relative;
+}
+
+PathSettings ProjectConfig::resolve(std::string_view path) const {
+    PathSettings settings;
+    if (languages_) {
+        settings.languages = &*languages_;
+    }
+    auto relative = relative_path(path);
+    if (!relative) {
+        return settings;
+    }
+    if (ignores_ && ignores_->matches(*relative)) {
+        settings.skip = true;
+        return settings;
+    }
+    if (sections_.empty()) {
+        return settings;
+    }
+
+    // Every node the path or one of its parent directories reaches
+    std::vector<NodeId> active{root_id};
+    std::vector<NodeId> next;
+    std::vector<uint32_t> matched;
+    auto collect = [&] {
+        for (NodeId id : active) {
+            const auto& sections = nodes_[id].sections;
+            matched.insert(matched.end(), sections.begin(), sections.end());
+        }
+    };
+    expand(active);
+    collect();
+
+    std::string component;
+    size_t pos = 0;
+    while (pos < relative->size() && !active.empty()) {
+        size_t end = relative->find('/', pos);
+        if (end == std::string::npos) {
+            end = relative->size();
+        }
+        component.assign(*relative, pos, end - pos);
+        pos = end + 1;
+
+        next.clear();
+        for (NodeId id : active) {
+            const auto& node = nodes_[id];
+            if (node.is_globstar) {
+                next.push_back(id);
+            }
+            if (auto it = node.literals.find(component); it != node.literals.end()) {
+                next.push_back(it->second);
+            }
+            for (const auto& [glob, child_id] : node.patterns) {
+                if (glob.matches(component)) {
+                    next.push_back(child_id);
+                }
+            }
+        }
+        expand(next);
+        std::swap(active, next);
+        collect();
+    }
+
+    std::sort(matched.begin(), matched.end());
+    matched.erase(std::unique(matched.begin(), matched.end()), matched.end());
+    for (uint32_t index : matched) {
+        const auto& section = sections_[index];
+        if (section.threshold) {
+            settings.threshold = section.threshold;
+        }
+        if (section.languages) {
+            settings.languages = &*section.languages;
+        }
+        if (section.skip) {
+            settings.skip = *section.skip;
+        }
+    }
+    return settings;
+}
+
+} // namespace catchy::analysis
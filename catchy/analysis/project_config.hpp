@@ -0,0 +1,117 @@
+#ifndef CATCHY_ANALYSIS_PROJECT_CONFIG_HPP
+#define CATCHY_ANALYSIS_PROJECT_CONFIG_HPP
+
+#pragma once
+
+#include "utils/glob.hpp"
+#include "utils/ignore.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace catchy::analysis {
+
+// Settings that apply to one file, resolved from the config file
+struct PathSettings {
+    std::optional<size_t> threshold;
+    // Languages to analyze; null for all of them
+    const std::vector<std::string> *languages {nullptr};
+    bool skip {false};
+
+    bool allows_language(const std::string &language) const;
+};
+
+// Output options of the [output] table; unset ones defer to the command line
+struct OutputSettings {
+    std::optional<bool> rollup;
+    std::optional<size_t> depth;
+    std::optional<bool> aggregate_only;
+    std::optional<bool> explain;
+    std::optional<std::string> snapshot;
+};
+
+// Per-file budgets of the [limits] table; unset ones defer to the command line
+struct LimitSettings {
+    std::optional<size_t> parse_timeout_ms;
+    std::optional<size_t> max_nodes;
+    std::optional<size_t> max_depth;
+    std::optional<size_t> max_error_percent;
+    std::optional<size_t> memory_limit_mb;
+    std::optional<size_t> max_inflight_bytes;
+};
+
+// A .catchy.toml file. Its [[path]] sections are compiled at load time into
+// a trie keyed by path component, so resolving a file walks its components
+// once. Paths are matched relative to the directory holding the config.
+// Immutable once loaded and shared between threads.
+class ProjectConfig {
+public:
+    static constexpr const char *file_name = ".catchy.toml";
+
+    // Throws std::runtime_error on unreadable or malformed files
+    static ProjectConfig load(const std::string &path);
+    static ProjectConfig parse(std::string_view text, const std::string &path);
+
+    // Nearest config file in `start` or a directory above it, stopping at
+    // the repository root
+    static std::optional<std::string> find(const std::string &start);
+
+    // Settings for `path`, given as the walker builds it. Later sections win
+    // over earlier ones; paths outside the config's directory only get the
+    // top-level settings.
+    PathSettings resolve(std::string_view path) const;
+
+    std::optional<size_t> threshold() const { return threshold_; }
+    const OutputSettings &output() const { return output_; }
+    const LimitSettings &limits() const { return limits_; }
+    const std::string &path() const { return path_; }
+
+private:
+    using NodeId = uint32_t;
+    static constexpr NodeId root_id = 0;
+    static constexpr NodeId no_node = 0;
+
+    struct Section {
+        std::optional<size_t> threshold;
+        std::optional<std::vector<std::string>> languages;
+        std::optional<bool> skip;
+    };
+
+    struct Node {
+        std::unordered_map<std::string, NodeId> literals;
+        std::vector<std::pair<utils::Glob, NodeId>> patterns;
+        // "**" child, matching any number of components
+        NodeId globstar {no_node};
+        bool is_globstar {false};
+        // Sections whose pattern ends here, in declaration order
+        std::vector<uint32_t> sections;
+    };
+
+    void add_section(std::string_view pattern, Section section);
+    NodeId child(NodeId parent, std::string_view component);
+    void expand(std::vector<NodeId> &nodes) const;
+    std::optional<std::string> relative_path(std::string_view path) const;
+
+    std::string path_;
+    std::filesystem::path root_;
+    std::filesystem::path working_directory_;
+
+    std::optional<size_t> threshold_;
+    std::optional<std::vector<std::string>> languages_;
+    // Top-level `ignore`, matched against paths relative to the config
+    std::shared_ptr<const utils::IgnorePatterns> ignores_;
+    OutputSettings output_;
+    LimitSettings limits_;
+
+    std::vector<Section> sections_;
+    std::vector<Node> nodes_;
+};
+
+} // namespace catchy::analysis
+
+#endif // CATCHY_ANALYSIS_PROJECT_CONFIG_HPP
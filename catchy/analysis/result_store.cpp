@@ -0,0 +1,148 @@
+#include "result_store.hpp"
+#include "utils/safe_conversions.hpp"
+#include <algorithm>
+
+namespace catchy::analysis {
+
+namespace {
+
+template <typename T>
+size_t bytes_of(const std::vector<T> &column) {
+    return column.size() * sizeof(T);
+}
+
+} // namespace
+
+std::string_view ResultStore::Row::function_name() const {
+    uint32_t begin = index_ ? store_->name_ends_[index_ - 1] : 0;
+    return std::string_view(store_->names_).substr(begin, store_->name_ends_[index_] - begin);
+}
+
+std::span<const complexity::ComplexityFactor> ResultStore::Row::factors() const {
+    uint32_t begin = index_ ? store_->factor_ends_[index_ - 1] : 0;
+    return std::span(store_->factors_).subspan(begin, store_->factor_ends_[index_] - begin);
+}
+
+std::string_view ResultStore::Row::snippet(size_t factor) const {
+    size_t i = (index_ ? store_->factor_ends_[index_ - 1] : 0) + factor;
+    uint32_t begin = i ? store_->snippet_ends_[i - 1] : 0;
+    return std::string_view(store_->snippets_).substr(begin, store_->snippet_ends_[i] - begin);
+}
+
+void ResultStore::append(AnalysisResult &&result) {
+    file_paths_.push_back(result.file_path);
+    languages_.push_back(result.language);
+    start_lines_.push_back(utils::safe_cast<uint32_t>(result.start_line));
+    end_lines_.push_back(utils::safe_cast<uint32_t>(result.end_line));
+    complexities_.push_back(utils::safe_cast<uint32_t>(result.complexity));
+    bool snippets = !result.snippets.empty();
+    flags_.push_back((result.approximate ? approximate_flag : 0) | (snippets ? snippets_flag : 0) |
+                     (result.below_threshold ? below_threshold_flag : 0));
+    grammars_.push_back(result.grammar);
+
+    names_ += result.function_name;
+    name_ends_.push_back(utils::safe_cast<uint32_t>(names_.size()));
+
+    factors_.insert(factors_.end(), result.factors.begin(), result.factors.end());
+    factor_ends_.push_back(utils::safe_cast<uint32_t>(factors_.size()));
+    for (size_t i = 0; i < result.factors.size(); ++i) {
+        if (snippets && i < result.snippets.size()) {
+            snippets_ += result.snippets[i];
+        }
+        snippet_ends_.push_back(utils::safe_cast<uint32_t>(snippets_.size()));
+    }
+}
+
+void ResultStore::append(const ResultStore &other, size_t begin, size_t end) {
+    if (begin >= end) {
+        return;
+    }
+    auto copy = [begin, end](auto &to, const auto &from) {
+        to.insert(to.end(), from.begin() + static_cast<std::ptrdiff_t>(begin),
+                  from.begin() + static_cast<std::ptrdiff_t>(end));
+    };
+    copy(file_paths_, other.file_paths_);
+    copy(languages_, other.languages_);
+    copy(start_lines_, other.start_lines_);
+    copy(end_lines_, other.end_lines_);
+    copy(complexities_, other.complexities_);
+    copy(flags_, other.flags_);
+    copy(grammars_, other.grammars_);
+
+    // Buffers are copied as one block, with their end offsets rebased
+    auto append_buffer = [](auto &to, std::vector<uint32_t> &to_ends, const auto &from,
+                            const std::vector<uint32_t> &from_ends, size_t first, size_t last) {
+        uint32_t from_begin = first ? from_ends[first - 1] : 0;
+        uint32_t from_end = last ? from_ends[last - 1] : 0;
+        size_t base = to.size();
+        to.insert(to.end(), from.begin() + from_begin, from.begin() + from_end);
+        for (size_t i = first; i < last; ++i) {
+            to_ends.push_back(utils::safe_cast<uint32_t>(base + from_ends[i] - from_begin));
+        }
+    };
+    uint32_t first_factor = begin ? other.factor_ends_[begin - 1] : 0;
+    uint32_t last_factor = other.factor_ends_[end - 1];
+    append_buffer(names_, name_ends_, other.names_, other.name_ends_, begin, end);
+    append_buffer(factors_, factor_ends_, other.factors_, other.factor_ends_, begin, end);
+    append_buffer(snippets_, snippet_ends_, other.snippets_, other.snippet_ends_, first_factor, last_factor);
+}
+
+void ResultStore::reserve(size_t rows) {
+    file_paths_.reserve(rows);
+    languages_.reserve(rows);
+    start_lines_.reserve(rows);
+    end_lines_.reserve(rows);
+    complexities_.reserve(rows);
+    flags_.reserve(rows);
+    grammars_.reserve(rows);
+    name_ends_.reserve(rows);
+    factor_ends_.reserve(rows);
+}
+
+void ResultStore::truncate(size_t rows) {
+    if (rows >= size()) {
+        return;
+    }
+    size_t factors = rows ? factor_ends_[rows - 1] : 0;
+    file_paths_.resize(rows);
+    languages_.resize(rows);
+    start_lines_.resize(rows);
+    end_lines_.resize(rows);
+    complexities_.resize(rows);
+    flags_.resize(rows);
+    grammars_.resize(rows);
+    names_.resize(rows ? name_ends_[rows - 1] : 0);
+    name_ends_.resize(rows);
+    snippets_.resize(factors ? snippet_ends_[factors - 1] : 0);
+    snippet_ends_.resize(factors);
+    factors_.resize(factors);
+    factor_ends_.resize(rows);
+}
+
+std::vector<uint32_t> ResultStore::sorted_rows() const {
+    std::vector<uint32_t> order(size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::sort(order.begin(), order.end(), [this](uint32_t lhs, uint32_t rhs) {
+        if (file_paths_[lhs] != file_paths_[rhs]) {
+            return file_paths_[lhs] < file_paths_[rhs];
+        }
+        Row left(*this, lhs);
+        Row right(*this, rhs);
+        if (int c = left.function_name().compare(right.function_name()); c != 0) {
+            return c < 0;
+        }
+        return start_lines_[lhs] < start_lines_[rhs];
+    });
+    return order;
+}
+
+size_t ResultStore::memory_usage() const {
+    return bytes_of(file_paths_) + bytes_of(languages_) + bytes_of(start_lines_) + bytes_of(end_lines_) +
+           bytes_of(complexities_) + bytes_of(flags_) + bytes_of(grammars_) + names_.size() +
+           bytes_of(name_ends_) + bytes_of(factors_) + bytes_of(factor_ends_) + snippets_.size() +
+           bytes_of(snippet_ends_);
+}
+
+} // namespace catchy::analysis
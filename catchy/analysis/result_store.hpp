@@ -0,0 +1,141 @@
+#ifndef CATCHY_ANALYSIS_RESULT_STORE_HPP
+#define CATCHY_ANALYSIS_RESULT_STORE_HPP
+
+#pragma once
+
+#include "complexity/cognitive_complexity.hpp"
+#include "utils/intern.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <tree_sitter/api.h>
+
+namespace catchy::analysis {
+
+// One reported function while it is being built; stored as a row of a
+// ResultStore once complete
+struct AnalysisResult {
+    // Shared by every result of a file
+    utils::InternedString file_path;
+    utils::InternedString language;
+    // The source is freed after each file, so names are owned copies
+    std::string function_name;
+    size_t start_line;
+    size_t end_line;
+    size_t complexity;
+    std::vector<complexity::ComplexityFactor> factors;
+    // Grammar the factor symbols belong to
+    const TSLanguage *grammar {nullptr};
+    // Trimmed source line of each factor, only filled when explaining
+    std::vector<std::string> snippets;
+    // Estimated by the fast scanner, either by request or because parse
+    // errors covered too much of the file to trust its tree
+    bool approximate {false};
+    // Scored under its threshold; only kept for snapshots, never displayed
+    bool below_threshold {false};
+
+    // Serialize to TOML
+    std::string to_toml() const;
+};
+
+// Results of a run in columns: one entry per row in each array, with the
+// names, factors and snippets of all rows packed into flat buffers addressed
+// by offset. Appending costs no allocation once the buffers have grown, and
+// sorting or totalling only touches the columns it reads.
+class ResultStore {
+public:
+    // Read-only view of one row, valid until the store is modified
+    class Row {
+    public:
+        Row(const ResultStore &store, size_t index) : store_(&store), index_(index) {}
+
+        utils::InternedString file_path() const { return store_->file_paths_[index_]; }
+        utils::InternedString language() const { return store_->languages_[index_]; }
+        std::string_view function_name() const;
+        size_t start_line() const { return store_->start_lines_[index_]; }
+        size_t end_line() const { return store_->end_lines_[index_]; }
+        size_t complexity() const { return store_->complexities_[index_]; }
+        bool approximate() const { return store_->flags_[index_] & approximate_flag; }
+        bool below_threshold() const { return store_->flags_[index_] & below_threshold_flag; }
+        const TSLanguage *grammar() const { return store_->grammars_[index_]; }
+        std::span<const complexity::ComplexityFactor> factors() const;
+        // Snippets are recorded for all of a row's factors or none of them
+        bool has_snippets() const { return store_->flags_[index_] & snippets_flag; }
+        std::string_view snippet(size_t factor) const;
+
+        size_t index() const { return index_; }
+
+    private:
+        const ResultStore *store_;
+        size_t index_;
+    };
+
+    class iterator {
+    public:
+        iterator(const ResultStore &store, size_t index) : store_(&store), index_(index) {}
+        Row operator*() const { return Row(*store_, index_); }
+        iterator &operator++() {
+            ++index_;
+            return *this;
+        }
+        bool operator==(const iterator &other) const { return index_ == other.index_; }
+        bool operator!=(const iterator &other) const { return index_ != other.index_; }
+
+    private:
+        const ResultStore *store_;
+        size_t index_;
+    };
+
+    ResultStore() = default;
+
+    void append(AnalysisResult &&result);
+    // Rows [begin, end) of `other`, in order
+    void append(const ResultStore &other, size_t begin, size_t end);
+    void append(const ResultStore &other) { append(other, 0, other.size()); }
+    void reserve(size_t rows);
+    // Drop every row from `rows` on
+    void truncate(size_t rows);
+    void clear() { truncate(0); }
+
+    size_t size() const { return file_paths_.size(); }
+    bool empty() const { return file_paths_.empty(); }
+    Row operator[](size_t index) const { return Row(*this, index); }
+    iterator begin() const { return iterator(*this, 0); }
+    iterator end() const { return iterator(*this, size()); }
+
+    // Row indices ordered by (file, function, start line)
+    std::vector<uint32_t> sorted_rows() const;
+    // Bytes used by the rows; spare capacity, at most as much again, is not
+    // counted
+    size_t memory_usage() const;
+
+private:
+    static constexpr uint8_t approximate_flag = 1;
+    static constexpr uint8_t snippets_flag = 2;
+    static constexpr uint8_t below_threshold_flag = 4;
+
+    std::vector<utils::InternedString> file_paths_;
+    std::vector<utils::InternedString> languages_;
+    std::vector<uint32_t> start_lines_;
+    std::vector<uint32_t> end_lines_;
+    std::vector<uint32_t> complexities_;
+    std::vector<uint8_t> flags_;
+    std::vector<const TSLanguage *> grammars_;
+
+    // Row i's name is names_[name_ends_[i - 1], name_ends_[i])
+    std::string names_;
+    std::vector<uint32_t> name_ends_;
+    // Row i's factors are factors_[factor_ends_[i - 1], factor_ends_[i])
+    std::vector<complexity::ComplexityFactor> factors_;
+    std::vector<uint32_t> factor_ends_;
+    // One end offset per factor; empty snippets for rows without them
+    std::string snippets_;
+    std::vector<uint32_t> snippet_ends_;
+};
+
+} // namespace catchy::analysis
+
+#endif // CATCHY_ANALYSIS_RESULT_STORE_HPP
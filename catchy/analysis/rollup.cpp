@@ -0,0 +1,99 @@
+#include "rollup.hpp"
+#include <algorithm>
+
+namespace catchy::analysis {
+
+PathTrie::PathTrie() {
+    nodes_.emplace_back();
+    nodes_.back().name = ".";
+    nodes_.back().parent = root_id;
+}
+
+PathTrie::NodeId PathTrie::find_or_insert_child(NodeId parent, std::string_view name) {
+    auto& children = nodes_[parent].children;
+    auto it = std::lower_bound(children.begin(), children.end(), name,
+        [this](NodeId child, std::string_view key) {
+            return std::string_view(nodes_[child].name) < key;
+        });
+    if (it != children.end() && nodes_[*it].name == name) {
+        return *it;
+    }
+
+    auto id = static_cast<NodeId>(nodes_.size());
+    // Insert before growing nodes_, which may invalidate the children reference
+    children.insert(it, id);
+    nodes_.emplace_back();
+    nodes_.back().name = std::string(name);
+    nodes_.back().parent = parent;
+    return id;
+}
+
+PathTrie::NodeId PathTrie::insert_file(std::string_view path) {
+    if (!path.empty() && path.front() == '/') {
+        nodes_[root_id].name = "/";
+    }
+
+    NodeId current = root_id;
+    size_t pos = 0;
+    while (pos <= path.size()) {
+        size_t next = path.find('/', pos);
+        if (next == std::string_view::npos) {
+            next = path.size();
+        }
+        auto component = path.substr(pos, next - pos);
+        if (!component.empty() && component != ".") {
+            current = find_or_insert_child(current, component);
+        }
+        pos = next + 1;
+    }
+
+    nodes_[current].is_file = true;
+    return current;
+}
+
+void PathTrie::merge(const PathTrie& other) {
+    // Other's parents precede their children, so a single forward pass can
+    // map every node onto this trie
+    std::vector<NodeId> mapping(other.nodes_.size(), root_id);
+    for (NodeId id = 0; id < other.nodes_.size(); ++id) {
+        const auto& source = other.nodes_[id];
+        NodeId target = id == root_id
+            ? root_id
+            : find_or_insert_child(mapping[source.parent], source.name);
+        mapping[id] = target;
+        nodes_[target].is_file = nodes_[target].is_file || source.is_file;
+        nodes_[target].own.merge(source.own);
+    }
+    if (other.nodes_[root_id].name == "/") {
+        nodes_[root_id].name = "/";
+    }
+}
+
+void PathTrie::finalize() {
+    for (auto& node : nodes_) {
+        node.total = node.own;
+        node.total.files = node.is_file ? 1 : 0;
+    }
+    for (NodeId id = static_cast<NodeId>(nodes_.size()) - 1; id > root_id; --id) {
+        nodes_[nodes_[id].parent].total.merge(nodes_[id].total);
+    }
+}
+
+void PathTrie::visit(size_t max_depth,
+                     const std::function<void(const Node&, size_t, bool)>& visitor) const {
+    visit_node(root_id, 0, true, max_depth, visitor);
+}
+
+void PathTrie::visit_node(NodeId id, size_t depth, bool last, size_t max_depth,
+                          const std::function<void(const Node&, size_t, bool)>& visitor) const {
+    const auto& node = nodes_[id];
+    visitor(node, depth, last);
+    if (max_depth != 0 && depth >= max_depth) {
+        return;
+    }
+    for (size_t i = 0; i < node.children.size(); ++i) {
+        visit_node(node.children[i], depth + 1, i + 1 == node.children.size(), max_depth, visitor);
+    }
+}
+
+} // namespace catchy::analysis
@@ -0,0 +1,88 @@
+#ifndef CATCHY_ANALYSIS_ROLLUP_HPP
+#define CATCHY_ANALYSIS_ROLLUP_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace catchy::analysis {
+
+struct RollupStats {
+    size_t sum{0};
+    size_t max{0};
+    size_t functions{0};
+    size_t over_threshold{0};
+    size_t files{0};
+
+    void add(size_t complexity, bool over) {
+        sum += complexity;
+        max = complexity > max ? complexity : max;
+        functions++;
+        over_threshold += over ? 1 : 0;
+    }
+
+    void merge(const RollupStats &other) {
+        sum += other.sum;
+        max = other.max > max ? other.max : max;
+        functions += other.functions;
+        over_threshold += other.over_threshold;
+        files += other.files;
+    }
+};
+
+// Path trie that rolls per-function complexity up to every directory level.
+// Scores are recorded on file nodes only; finalize() folds them into the
+// ancestors in a single reverse pass, relying on parents always having a
+// smaller id than their children.
+class PathTrie {
+public:
+    using NodeId = uint32_t;
+    static constexpr NodeId root_id = 0;
+
+    struct Node {
+        std::string name;
+        NodeId parent{root_id};
+        bool is_file{false};
+        std::vector<NodeId> children; // Sorted by name
+        RollupStats own;
+        RollupStats total;
+    };
+
+    PathTrie();
+
+    // Insert (or find) the node for a file path, one component at a time
+    NodeId insert_file(std::string_view path);
+    void record(NodeId file, size_t complexity, bool over_threshold) {
+        nodes_[file].own.add(complexity, over_threshold);
+    }
+
+    // Fold another trie into this one; tries are owned by a single thread
+    // each and merged after the workers have joined, so no locking is needed
+    void merge(const PathTrie &other);
+
+    // Compute the rolled-up totals of every node
+    void finalize();
+
+    const Node &node(NodeId id) const { return nodes_[id]; }
+    size_t size() const { return nodes_.size(); }
+    bool empty() const { return nodes_.size() == 1 && nodes_[root_id].own.functions == 0; }
+
+    // Depth-first, name-ordered walk; depth 0 is the root, max_depth 0 means unlimited
+    void visit(size_t max_depth, const std::function<void(const Node &, size_t depth, bool last)> &visitor) const;
+
+private:
+    NodeId find_or_insert_child(NodeId parent, std::string_view name);
+    void visit_node(NodeId id, size_t depth, bool last, size_t max_depth,
+                    const std::function<void(const Node &, size_t, bool)> &visitor) const;
+
+    std::vector<Node> nodes_;
+};
+
+} // namespace catchy::analysis
+
+#endif // CATCHY_ANALYSIS_ROLLUP_HPP
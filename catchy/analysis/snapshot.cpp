@@ -0,0 +1,531 @@
+#include "snapshot.hpp"
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <span>
+#include <stdexcept>
+
+namespace catchy::analysis {
+
+namespace {
+
+constexpr const char* header_fields = "{\"catchy_snapshot\":1,\"sorted\":true";
+
+void append_escaped(std::string& out, std::string_view text) {
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    static const char* hex = "0123456789abcdef";
+                    out += "\\u00";
+                    out += hex[(c >> 4) & 0xf];
+                    out += hex[c & 0xf];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+// Opens the record object; the caller closes it
+void append_fields(std::string& line, std::string_view file, std::string_view function, std::string_view language,
+                   size_t start_line, size_t end_line, size_t complexity, bool approximate,
+                   bool below_threshold) {
+    line += "{\"file\":";
+    append_escaped(line, file);
+    line += ",\"function\":";
+    append_escaped(line, function);
+    line += ",\"language\":";
+    append_escaped(line, language);
+    line += ",\"start_line\":" + std::to_string(start_line);
+    line += ",\"end_line\":" + std::to_string(end_line);
+    line += ",\"complexity\":" + std::to_string(complexity);
+    if (approximate) {
+        line += ",\"approximate\":true";
+    }
+    if (below_threshold) {
+        line += ",\"below_threshold\":true";
+    }
+}
+
+template <typename Snippet>
+void append_details(std::string& line, std::span<const complexity::ComplexityFactor> factors, bool has_snippets,
+                    Snippet snippet) {
+    if (factors.empty()) {
+        return;
+    }
+    line += ",\"factors\":[";
+    for (size_t i = 0; i < factors.size(); ++i) {
+        const auto& factor = factors[i];
+        line += i ? ",[" : "[";
+        line += std::to_string(static_cast<unsigned>(factor.kind)) + "," + std::to_string(factor.symbol) + "," +
+                std::to_string(factor.increment) + "," + std::to_string(factor.line_number) + "]";
+    }
+    line += "]";
+    if (has_snippets) {
+        line += ",\"snippets\":[";
+        for (size_t i = 0; i < factors.size(); ++i) {
+            if (i) {
+                line += ",";
+            }
+            append_escaped(line, snippet(i));
+        }
+        line += "]";
+    }
+}
+
+void append_utf8(std::string& out, uint32_t code_point) {
+    if (code_point < 0x80) {
+        out += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        out += static_cast<char>(0xc0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3f));
+    } else if (code_point < 0x10000) {
+        out += static_cast<char>(0xe0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code_point & 0x3f));
+    } else {
+        out += static_cast<char>(0xf0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code_point & 0x3f));
+    }
+}
+
+// Minimal parser for the flat objects catchy writes: string, integer and
+// literal values, plus the factor and snippet arrays of detailed records
+class LineParser {
+public:
+    explicit LineParser(std::string_view text) : text_(text) {}
+
+    // Returns false if the line is a snapshot header instead of a record
+    bool parse(SnapshotRecord& record) {
+        bool is_record = true;
+        expect('{');
+        skip_whitespace();
+        if (peek() == '}') {
+            return true;
+        }
+        std::string key;
+        std::string value;
+        while (true) {
+            key = parse_string();
+            expect(':');
+            skip_whitespace();
+            if (peek() == '"') {
+                value = parse_string();
+                if (key == "file") record.file_path = std::move(value);
+                else if (key == "function") record.function_name = std::move(value);
+                else if (key == "language") record.language = std::move(value);
+            } else if (peek() == '[') {
+                if (key == "factors") parse_factors(record.factors);
+                else if (key == "snippets") parse_strings(record.snippets);
+                else throw std::runtime_error("unexpected array for '" + key + "'");
+            } else if (peek() == '-' || (peek() >= '0' && peek() <= '9')) {
+                size_t number = parse_number();
+                if (key == "start_line") record.start_line = number;
+                else if (key == "end_line") record.end_line = number;
+                else if (key == "complexity") record.complexity = number;
+                else if (key == "catchy_snapshot") is_record = false;
+            } else {
+                size_t start = pos_;
+                skip_literal();
+                bool value = text_.substr(start, pos_ - start) == "true";
+                if (key == "approximate") record.approximate = value;
+                else if (key == "below_threshold") record.below_threshold = value;
+            }
+            skip_whitespace();
+            if (peek() == ',') {
+                ++pos_;
+                continue;
+            }
+            expect('}');
+            return is_record;
+        }
+    }
+
+private:
+    char peek() const { return pos_ < text_.size() ? text_[pos_] : '\0'; }
+
+    void skip_whitespace() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    void expect(char c) {
+        skip_whitespace();
+        if (peek() != c) {
+            throw std::runtime_error(std::string("expected '") + c + "'");
+        }
+        ++pos_;
+    }
+
+    uint32_t parse_hex4() {
+        if (pos_ + 4 > text_.size()) {
+            throw std::runtime_error("truncated unicode escape");
+        }
+        uint32_t value = std::stoul(std::string(text_.substr(pos_, 4)), nullptr, 16);
+        pos_ += 4;
+        return value;
+    }
+
+    std::string parse_string() {
+        expect('"');
+        std::string out;
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            char c = text_[pos_++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            char escape = peek();
+            ++pos_;
+            switch (escape) {
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    uint32_t code_point = parse_hex4();
+                    if (code_point >= 0xd800 && code_point < 0xdc00 &&
+                        text_.substr(pos_, 2) == "\\u") {
+                        pos_ += 2;
+                        uint32_t low = parse_hex4();
+                        code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+                    }
+                    append_utf8(out, code_point);
+                    break;
+                }
+                default: out += escape; break;
+            }
+        }
+        expect('"');
+        return out;
+    }
+
+    size_t parse_number() {
+        size_t start = pos_;
+        while (pos_ < text_.size() && (std::isdigit(static_cast<unsigned char>(text_[pos_])) ||
+                                       text_[pos_] == '-')) {
+            ++pos_;
+        }
+        auto digits = text_.substr(start, pos_ - start);
+        if (digits.empty() || digits.front() == '-') {
+            return 0;
+        }
+        return std::stoull(std::string(digits));
+    }
+
+    // [[kind, symbol, increment, line], ...]
+    void parse_factors(std::vector<complexity::ComplexityFactor>& factors) {
+        expect('[');
+        skip_whitespace();
+        while (peek() == '[') {
+            ++pos_;
+            complexity::ComplexityFactor factor {};
+            factor.kind = static_cast<complexity::FactorKind>(parse_field(','));
+            factor.symbol = static_cast<TSSymbol>(parse_field(','));
+            factor.increment = static_cast<uint32_t>(parse_field(','));
+            factor.line_number = static_cast<uint32_t>(parse_field(']'));
+            factors.push_back(factor);
+            if (!next_element()) {
+                break;
+            }
+        }
+        expect(']');
+    }
+
+    void parse_strings(std::vector<std::string>& strings) {
+        expect('[');
+        skip_whitespace();
+        while (peek() == '"') {
+            strings.push_back(parse_string());
+            if (!next_element()) {
+                break;
+            }
+        }
+        expect(']');
+    }
+
+    size_t parse_field(char terminator) {
+        skip_whitespace();
+        size_t value = parse_number();
+        expect(terminator);
+        return value;
+    }
+
+    bool next_element() {
+        skip_whitespace();
+        if (peek() != ',') {
+            return false;
+        }
+        ++pos_;
+        skip_whitespace();
+        return true;
+    }
+
+    void skip_literal() {
+        while (pos_ < text_.size() && std::isalpha(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+        }
+    }
+
+    std::string_view text_;
+    size_t pos_ {0};
+};
+
+class RecordSource {
+public:
+    virtual ~RecordSource() = default;
+    virtual bool next(SnapshotRecord& record) = 0;
+};
+
+// Streams a sorted snapshot, verifying the order as it goes
+class StreamingSource : public RecordSource {
+public:
+    explicit StreamingSource(const std::string& path) : path_(path), reader_(path) {}
+
+    bool next(SnapshotRecord& record) override {
+        if (!reader_.next(record)) {
+            return false;
+        }
+        if (has_previous_ && record < previous_) {
+            throw std::runtime_error("Snapshot is not sorted: " + path_);
+        }
+        previous_ = record;
+        has_previous_ = true;
+        return true;
+    }
+
+private:
+    std::string path_;
+    SnapshotReader reader_;
+    SnapshotRecord previous_;
+    bool has_previous_ {false};
+};
+
+class SortedSource : public RecordSource {
+public:
+    explicit SortedSource(const std::string& path) {
+        SnapshotReader reader(path);
+        SnapshotRecord record;
+        while (reader.next(record)) {
+            records_.push_back(std::move(record));
+        }
+        std::sort(records_.begin(), records_.end());
+    }
+
+    bool next(SnapshotRecord& record) override {
+        if (index_ >= records_.size()) {
+            return false;
+        }
+        record = std::move(records_[index_++]);
+        return true;
+    }
+
+private:
+    std::vector<SnapshotRecord> records_;
+    size_t index_ {0};
+};
+
+bool is_sorted_file(const std::string& path) {
+    SnapshotReader reader(path);
+    if (reader.is_sorted()) {
+        return true;
+    }
+    SnapshotRecord previous;
+    SnapshotRecord current;
+    bool first = true;
+    while (reader.next(current)) {
+        if (!first && current < previous) {
+            return false;
+        }
+        std::swap(previous, current);
+        first = false;
+    }
+    return true;
+}
+
+std::unique_ptr<RecordSource> open_source(const std::string& path) {
+    if (is_sorted_file(path)) {
+        return std::make_unique<StreamingSource>(path);
+    }
+    return std::make_unique<SortedSource>(path);
+}
+
+} // namespace
+
+int compare_keys(const SnapshotRecord& lhs, const SnapshotRecord& rhs) {
+    if (int c = lhs.file_path.compare(rhs.file_path); c != 0) {
+        return c;
+    }
+    if (int c = lhs.function_name.compare(rhs.function_name); c != 0) {
+        return c;
+    }
+    if (lhs.start_line != rhs.start_line) {
+        return lhs.start_line < rhs.start_line ? -1 : 1;
+    }
+    return 0;
+}
+
+bool SnapshotRecord::operator<(const SnapshotRecord& other) const {
+    return compare_keys(*this, other) < 0;
+}
+
+SnapshotWriter::SnapshotWriter(const std::string& path, bool details, const std::string& root)
+    : path_(path), output_(path, std::ios::binary), details_(details) {
+    if (!output_.is_open()) {
+        throw std::runtime_error("Failed to open snapshot for writing: " + path);
+    }
+    line_ = header_fields;
+    if (!root.empty()) {
+        root_prefix_ = root.back() == '/' ? root : root + '/';
+        line_ += ",\"root\":";
+        append_escaped(line_, root);
+    }
+    line_ += "}\n";
+    output_ << line_;
+}
+
+// Stripping the same prefix from every path keeps sorted rows sorted
+std::string_view SnapshotWriter::relative(std::string_view file_path) const {
+    if (!root_prefix_.empty() && file_path.size() > root_prefix_.size() &&
+        file_path.compare(0, root_prefix_.size(), root_prefix_) == 0) {
+        file_path.remove_prefix(root_prefix_.size());
+    }
+    return file_path;
+}
+
+void SnapshotWriter::write(ResultStore::Row row) {
+    line_.clear();
+    append_fields(line_, relative(row.file_path().str()), row.function_name(), row.language().str(), row.start_line(),
+                  row.end_line(), row.complexity(), row.approximate(), row.below_threshold());
+    if (details_) {
+        append_details(line_, row.factors(), row.has_snippets(), [&](size_t i) { return row.snippet(i); });
+    }
+    line_ += "}\n";
+    output_ << line_;
+}
+
+void SnapshotWriter::write(const SnapshotRecord& record) {
+    line_.clear();
+    append_fields(line_, relative(record.file_path), record.function_name, record.language, record.start_line,
+                  record.end_line, record.complexity, record.approximate, record.below_threshold);
+    if (details_) {
+        append_details(line_, record.factors, !record.snippets.empty(),
+                       [&](size_t i) { return std::string_view(record.snippets[i]); });
+    }
+    line_ += "}\n";
+    output_ << line_;
+}
+
+void SnapshotWriter::close() {
+    output_.close();
+    if (!output_) {
+        throw std::runtime_error("Failed to write snapshot: " + path_);
+    }
+}
+
+void write_snapshot(const std::string& path, const ResultStore& results, const std::string& root) {
+    SnapshotWriter writer(path, false, root);
+    for (uint32_t row : results.sorted_rows()) {
+        writer.write(results[row]);
+    }
+    writer.close();
+}
+
+SnapshotReader::SnapshotReader(const std::string& path) : path_(path), input_(path, std::ios::binary) {
+    if (!input_.is_open()) {
+        throw std::runtime_error("Failed to open snapshot: " + path);
+    }
+
+    // Peek at the first non-empty line for a header
+    while (std::getline(input_, line_)) {
+        ++line_number_;
+        if (line_.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        SnapshotRecord record;
+        try {
+            if (!LineParser(line_).parse(record)) {
+                sorted_ = line_.find("\"sorted\":true") != std::string::npos;
+                return;
+            }
+        } catch (const std::exception&) {
+            // Reported with the line number once the record is consumed
+        }
+        pending_ = true;
+        return;
+    }
+}
+
+bool SnapshotReader::next(SnapshotRecord& record) {
+    while (pending_ || std::getline(input_, line_)) {
+        if (!pending_) {
+            ++line_number_;
+        }
+        pending_ = false;
+        if (line_.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        record = SnapshotRecord{};
+        try {
+            if (LineParser(line_).parse(record)) {
+                return true;
+            }
+        } catch (const std::exception& e) {
+            throw std::runtime_error(path_ + ":" + std::to_string(line_number_) + ": " + e.what());
+        }
+    }
+    return false;
+}
+
+DiffSummary diff_snapshots(const std::string& old_path, const std::string& new_path,
+                           const DiffCallback& callback) {
+    DiffSummary summary;
+    auto old_source = open_source(old_path);
+    auto new_source = open_source(new_path);
+
+    SnapshotRecord old_record;
+    SnapshotRecord new_record;
+    bool has_old = old_source->next(old_record);
+    bool has_new = new_source->next(new_record);
+
+    while (has_old || has_new) {
+        int order = !has_old ? 1 : !has_new ? -1 : compare_keys(old_record, new_record);
+        if (order < 0) {
+            summary.removed++;
+            callback(DiffKind::Removed, &old_record, nullptr);
+            has_old = old_source->next(old_record);
+        } else if (order > 0) {
+            summary.added++;
+            callback(DiffKind::Added, nullptr, &new_record);
+            has_new = new_source->next(new_record);
+        } else {
+            if (new_record.complexity > old_record.complexity) {
+                summary.worsened++;
+                callback(DiffKind::Worsened, &old_record, &new_record);
+            } else if (new_record.complexity < old_record.complexity) {
+                summary.improved++;
+                callback(DiffKind::Improved, &old_record, &new_record);
+            } else {
+                summary.unchanged++;
+            }
+            has_old = old_source->next(old_record);
+            has_new = new_source->next(new_record);
+        }
+    }
+
+    return summary;
+}
+
+} // namespace catchy::analysis
@@ -0,0 +1,108 @@
+#ifndef CATCHY_ANALYSIS_SNAPSHOT_HPP
+#define CATCHY_ANALYSIS_SNAPSHOT_HPP
+
+#pragma once
+
+#include "analysis/result_store.hpp"
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace catchy::analysis {
+
+// A saved result: one NDJSON line per function, preceded by a header line.
+// Snapshots written by catchy are sorted by (file, function, start line) so
+// two of them can be diffed with a streaming merge join.
+struct SnapshotRecord {
+    std::string file_path;
+    std::string function_name;
+    std::string language;
+    size_t start_line {0};
+    size_t end_line {0};
+    size_t complexity {0};
+    // Estimated from a file tree-sitter could not parse cleanly
+    bool approximate {false};
+    // Under the threshold of its run, see Analyzer::set_keep_below_threshold
+    bool below_threshold {false};
+    // Only written with details, as spill runs are; snippets match factors
+    std::vector<complexity::ComplexityFactor> factors;
+    std::vector<std::string> snippets;
+
+    bool operator<(const SnapshotRecord &other) const;
+};
+
+int compare_keys(const SnapshotRecord &lhs, const SnapshotRecord &rhs);
+
+// Writes records in the order given, under a header declaring them sorted
+class SnapshotWriter {
+public:
+    // `details` adds the factors and snippets of each record. File paths
+    // under `root`, the analyzed directory, are written relative to it, so
+    // snapshots of two checkouts share their keys; the root is kept in the
+    // header.
+    explicit SnapshotWriter(const std::string &path, bool details = false, const std::string &root = "");
+
+    void write(ResultStore::Row row);
+    void write(const SnapshotRecord &record);
+    // Throws std::runtime_error if any write failed
+    void close();
+
+private:
+    std::string_view relative(std::string_view file_path) const;
+
+    std::string path_;
+    std::ofstream output_;
+    std::string line_;
+    bool details_;
+    // The root with a trailing separator; empty keeps paths as they are
+    std::string root_prefix_;
+};
+
+void write_snapshot(const std::string &path, const ResultStore &results, const std::string &root = "");
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(const std::string &path);
+
+    // Whether the header declares the records to be in key order
+    bool is_sorted() const { return sorted_; }
+
+    // Read the next record, returns false at the end of the snapshot
+    bool next(SnapshotRecord &record);
+
+private:
+    std::string path_;
+    std::ifstream input_;
+    std::string line_;
+    size_t line_number_ {0};
+    bool sorted_ {false};
+    bool pending_ {false};
+};
+
+enum class DiffKind {
+    Added,
+    Removed,
+    Worsened,
+    Improved
+};
+
+struct DiffSummary {
+    size_t added {0};
+    size_t removed {0};
+    size_t worsened {0};
+    size_t improved {0};
+    size_t unchanged {0};
+};
+
+// Merge join of two snapshots. Sorted snapshots are streamed; unsorted ones
+// are loaded and sorted in memory first. `old_record` is null for added
+// functions and `new_record` is null for removed ones.
+using DiffCallback = std::function<void(DiffKind kind, const SnapshotRecord *old_record,
+                                        const SnapshotRecord *new_record)>;
+DiffSummary diff_snapshots(const std::string &old_path, const std::string &new_path,
+                           const DiffCallback &callback);
+
+} // namespace catchy::analysis
+
+#endif // CATCHY_ANALYSIS_SNAPSHOT_HPP
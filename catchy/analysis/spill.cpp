@@ -0,0 +1,297 @@
+#include "spill.hpp"
+#include "analysis/snapshot.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <stdlib.h>
+
+namespace catchy::analysis {
+
+namespace {
+
+// One sorted input of a merge: a run file, or rows still in memory
+class MergeInput {
+public:
+    explicit MergeInput(const std::string &run) : reader_(std::make_unique<SnapshotReader>(run)) {}
+    explicit MergeInput(const ResultStore &rows) : rows_(&rows), order_(rows.sorted_rows()) {}
+
+    bool next() {
+        if (reader_) {
+            return reader_->next(record);
+        }
+        if (index_ >= order_.size()) {
+            return false;
+        }
+        auto row = (*rows_)[order_[index_++]];
+        record = SnapshotRecord{};
+        record.file_path = row.file_path().str();
+        record.function_name = row.function_name();
+        record.language = row.language().str();
+        record.start_line = row.start_line();
+        record.end_line = row.end_line();
+        record.complexity = row.complexity();
+        record.approximate = row.approximate();
+        record.below_threshold = row.below_threshold();
+        auto factors = row.factors();
+        record.factors.assign(factors.begin(), factors.end());
+        if (row.has_snippets()) {
+            for (size_t i = 0; i < factors.size(); ++i) {
+                record.snippets.emplace_back(row.snippet(i));
+            }
+        }
+        return true;
+    }
+
+    SnapshotRecord record;
+
+private:
+    std::unique_ptr<SnapshotReader> reader_;
+    const ResultStore *rows_ {nullptr};
+    std::vector<uint32_t> order_;
+    size_t index_ {0};
+};
+
+// Visits the records of all inputs in key order; ties keep input order
+void merge_records(const std::vector<std::string> &runs, const ResultStore *rest,
+                   const std::function<void(SnapshotRecord &)> &visit) {
+    std::vector<MergeInput> inputs;
+    inputs.reserve(runs.size() + 1);
+    for (const auto &run : runs) {
+        inputs.emplace_back(run);
+    }
+    if (rest) {
+        inputs.emplace_back(*rest);
+    }
+
+    auto after = [&inputs](size_t lhs, size_t rhs) {
+        int order = compare_keys(inputs[lhs].record, inputs[rhs].record);
+        return order != 0 ? order > 0 : lhs > rhs;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(after)> heap(after);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i].next()) {
+            heap.push(i);
+        }
+    }
+    while (!heap.empty()) {
+        size_t i = heap.top();
+        heap.pop();
+        visit(inputs[i].record);
+        if (inputs[i].next()) {
+            heap.push(i);
+        }
+    }
+}
+
+} // namespace
+
+ResultSpill::~ResultSpill() {
+    if (!directory_.empty()) {
+        std::error_code error;
+        std::filesystem::remove_all(directory_, error);
+    }
+}
+
+void ResultSpill::spill(ResultStore &results) {
+    if (results.empty()) {
+        return;
+    }
+
+    // Grammars of consecutive rows mostly repeat; collect them before locking
+    std::vector<std::pair<utils::InternedString, const TSLanguage *>> grammars;
+    for (auto row : results) {
+        if (row.grammar() && (grammars.empty() || grammars.back().first != row.language())) {
+            grammars.emplace_back(row.language(), row.grammar());
+        }
+    }
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (failed_) {
+            return;
+        }
+        try {
+            path = next_run_path().string();
+        } catch (const std::exception &e) {
+            spdlog::error("Failed to spill results, keeping them in memory: {}", e.what());
+            failed_ = true;
+            return;
+        }
+        grammars_.insert(grammars.begin(), grammars.end());
+    }
+
+    // Sorting and writing happen outside the lock, so workers spill in parallel
+    try {
+        SnapshotWriter writer(path, true);
+        for (uint32_t row : results.sorted_rows()) {
+            writer.write(results[row]);
+        }
+        writer.close();
+    } catch (const std::exception &e) {
+        spdlog::error("Failed to spill results, keeping them in memory: {}", e.what());
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        std::lock_guard<std::mutex> lock(mutex_);
+        failed_ = true;
+        return;
+    }
+
+    std::vector<Run> compaction;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        spdlog::debug("Spilled {} results to {}", results.size(), path);
+        runs_.push_back({std::move(path), 0});
+        spilled_rows_ += results.size();
+        compaction = take_compaction();
+    }
+    results.clear();
+    // A merge can fill the next level in turn
+    while (!compaction.empty()) {
+        compact(std::move(compaction));
+        std::lock_guard<std::mutex> lock(mutex_);
+        compaction = take_compaction();
+    }
+}
+
+size_t ResultSpill::runs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return runs_.size();
+}
+
+size_t ResultSpill::spilled_rows() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return spilled_rows_;
+}
+
+void ResultSpill::merge(const ResultStore &rest, size_t batch_rows,
+                        const std::function<void(const ResultStore &batch)> &visit) const {
+    std::vector<std::string> runs;
+    std::unordered_map<utils::InternedString, const TSLanguage *> grammars;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &run : runs_) {
+            runs.push_back(run.path);
+        }
+        grammars = grammars_;
+    }
+
+    ResultStore batch;
+    batch.reserve(std::min<size_t>(batch_rows, 1 << 16));
+    // Records arrive grouped by file, so each path is interned once
+    utils::InternedString path;
+    utils::InternedString language;
+    merge_records(runs, &rest, [&](SnapshotRecord &record) {
+        if (record.file_path != path.str()) {
+            path = utils::InternedString(record.file_path);
+        }
+        if (record.language != language.str()) {
+            language = utils::InternedString(record.language);
+        }
+
+        AnalysisResult result;
+        result.file_path = path;
+        result.language = language;
+        result.function_name = std::move(record.function_name);
+        result.start_line = record.start_line;
+        result.end_line = record.end_line;
+        result.complexity = record.complexity;
+        result.approximate = record.approximate;
+        result.below_threshold = record.below_threshold;
+        result.factors = std::move(record.factors);
+        result.snippets = std::move(record.snippets);
+        if (auto it = grammars.find(language); it != grammars.end()) {
+            result.grammar = it->second;
+        }
+        batch.append(std::move(result));
+
+        if (batch.size() >= std::max<size_t>(batch_rows, 1)) {
+            visit(batch);
+            batch.clear();
+        }
+    });
+    if (!batch.empty()) {
+        visit(batch);
+    }
+}
+
+std::filesystem::path ResultSpill::next_run_path() {
+    if (directory_.empty()) {
+        auto pattern = (std::filesystem::temp_directory_path() / "catchy_spill_XXXXXX").string();
+        if (!mkdtemp(pattern.data())) {
+            throw std::runtime_error("Failed to create a directory for spilled results in " +
+                                     std::filesystem::temp_directory_path().string());
+        }
+        directory_ = pattern;
+    }
+    return directory_ / ("run_" + std::to_string(next_run_++) + ".ndjson");
+}
+
+std::vector<ResultSpill::Run> ResultSpill::take_compaction() {
+    if (compaction_failed_) {
+        return {};
+    }
+    std::vector<size_t> counts;
+    for (const auto &run : runs_) {
+        counts.resize(std::max(counts.size(), run.level + 1));
+        counts[run.level]++;
+    }
+    for (size_t level = 0; level < counts.size(); ++level) {
+        if (counts[level] < max_merge_width) {
+            continue;
+        }
+        std::vector<Run> taken;
+        std::vector<Run> kept;
+        for (auto &run : runs_) {
+            if (run.level == level && taken.size() < max_merge_width) {
+                taken.push_back(std::move(run));
+            } else {
+                kept.push_back(std::move(run));
+            }
+        }
+        runs_ = std::move(kept);
+        return taken;
+    }
+    return {};
+}
+
+void ResultSpill::compact(std::vector<Run> runs) {
+    std::vector<std::string> paths;
+    for (const auto &run : runs) {
+        paths.push_back(run.path);
+    }
+    std::string path;
+    try {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            path = next_run_path().string();
+        }
+        SnapshotWriter writer(path, true);
+        merge_records(paths, nullptr, [&writer](SnapshotRecord &record) { writer.write(record); });
+        writer.close();
+    } catch (const std::exception &e) {
+        // The runs are still intact; the final merge then just opens more files
+        spdlog::warn("Failed to merge spilled runs: {}", e.what());
+        std::error_code error;
+        if (!path.empty()) {
+            std::filesystem::remove(path, error);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        compaction_failed_ = true;
+        runs_.insert(runs_.end(), std::make_move_iterator(runs.begin()), std::make_move_iterator(runs.end()));
+        return;
+    }
+
+    for (const auto &run : paths) {
+        std::error_code error;
+        std::filesystem::remove(run, error);
+    }
+    spdlog::debug("Merged {} spilled runs into {}", paths.size(), path);
+    std::lock_guard<std::mutex> lock(mutex_);
+    runs_.push_back({std::move(path), runs.front().level + 1});
+}
+
+} // namespace catchy::analysis
@@ -0,0 +1,81 @@
+#ifndef CATCHY_ANALYSIS_SPILL_HPP
+#define CATCHY_ANALYSIS_SPILL_HPP
+
+#pragma once
+
+#include "analysis/result_store.hpp"
+#include "utils/intern.hpp"
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace catchy::analysis {
+
+// Results moved out of memory once a run's result stores outgrow their
+// budget. Each spill writes one sorted run file in the snapshot format, with
+// factors and snippets included, to a temporary directory removed on
+// destruction. Reports stream a k-way merge of the runs.
+class ResultSpill {
+public:
+    // Runs of one level merged into a run of the next level at a time, so
+    // every row is rewritten once per level and the final merge opens at
+    // most max_merge_width - 1 runs per level
+    static constexpr size_t max_merge_width = 64;
+
+    explicit ResultSpill(size_t memory_limit) : memory_limit_(memory_limit) {}
+    ~ResultSpill();
+    ResultSpill(const ResultSpill &) = delete;
+    ResultSpill &operator=(const ResultSpill &) = delete;
+
+    // Bytes of results kept in memory across all stores
+    size_t memory_limit() const { return memory_limit_; }
+
+    // Sorts `results` into a new run file and clears them. Safe to call
+    // from several workers at once. Once writing a run fails, results are
+    // left in memory from then on.
+    void spill(ResultStore &results);
+
+    size_t runs() const;
+    size_t spilled_rows() const;
+
+    // Calls `visit` with every spilled row and those of `rest`, in batches
+    // of at most `batch_rows` ordered by (file, function, start line). Each
+    // call merges the runs afresh, so reports can make separate passes.
+    void merge(const ResultStore &rest, size_t batch_rows,
+               const std::function<void(const ResultStore &batch)> &visit) const;
+
+private:
+    struct Run {
+        std::string path;
+        // 0 for spilled stores, n + 1 for a merge of level n runs
+        size_t level;
+    };
+
+    // Called with the lock held
+    std::filesystem::path next_run_path();
+    // Removes the oldest max_merge_width runs of the lowest full level from
+    // runs_; empty when no level is full. Called with the lock held.
+    std::vector<Run> take_compaction();
+    // Merges the taken runs into one outside the lock, as runs are written
+    void compact(std::vector<Run> runs);
+
+    size_t memory_limit_;
+    mutable std::mutex mutex_;
+    std::filesystem::path directory_;
+    std::vector<Run> runs_;
+    size_t spilled_rows_ {0};
+    size_t next_run_ {0};
+    bool failed_ {false};
+    // Set once a merge fails; its runs are kept and merged when reporting
+    bool compaction_failed_ {false};
+    // Run files cannot hold grammar pointers; they are restored by language
+    std::unordered_map<utils::InternedString, const TSLanguage *> grammars_;
+};
+
+} // namespace catchy::analysis
+
+#endif // CATCHY_ANALYSIS_SPILL_HPP
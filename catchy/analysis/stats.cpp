@@ -0,0 +1,46 @@
+#include "stats.hpp"
+#include <chrono>
+#include <ctime>
+
+namespace catchy::analysis {
+
+namespace {
+
+uint64_t cpu_clock_nanos(clockid_t clock) {
+    timespec time {};
+    if (clock_gettime(clock, &time) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000 + static_cast<uint64_t>(time.tv_nsec);
+}
+
+} // namespace
+
+const char *describe(Phase phase) {
+    switch (phase) {
+        case Phase::Listing: return "listing";
+        case Phase::Reading: return "reading";
+        case Phase::Filtering: return "filtering";
+        case Phase::Parsing: return "parsing";
+        case Phase::Extraction: return "extraction";
+        case Phase::Scoring: return "scoring";
+        case Phase::Rendering: return "rendering";
+        default: return "unknown";
+    }
+}
+
+uint64_t wall_clock_nanos() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+uint64_t thread_cpu_nanos() {
+    return cpu_clock_nanos(CLOCK_THREAD_CPUTIME_ID);
+}
+
+uint64_t process_cpu_nanos() {
+    return cpu_clock_nanos(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+} // namespace catchy::analysis
@@ -0,0 +1,120 @@
+#ifndef CATCHY_ANALYSIS_STATS_HPP
+#define CATCHY_ANALYSIS_STATS_HPP
+
+#pragma once
+
+#include "utils/sniff.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace catchy::analysis {
+
+// Stages of a run timed under --stats
+enum class Phase : uint8_t {
+    Listing,    // Walking directories or listing git files, then selecting
+    Reading,    // Reading file contents
+    Filtering,  // Content sniffing and the file's keyword bound
+    Parsing,    // tree-sitter, including the parse error check
+    Extraction, // Finding the functions in the tree
+    Scoring,    // Scoring and explaining functions; the token scan in fast mode
+    Rendering,  // Printing results, explanations and the rollup
+    Count
+};
+
+const char *describe(Phase phase);
+
+struct PhaseTime {
+    uint64_t wall_nanos {0};
+    uint64_t cpu_nanos {0};
+};
+
+// Monotonic wall clock, and CPU time of the calling thread or whole process
+uint64_t wall_clock_nanos();
+uint64_t thread_cpu_nanos();
+uint64_t process_cpu_nanos();
+
+// Counters of one analysis run, kept per worker and merged at the end
+struct AnalysisStats {
+    size_t files_analyzed {0};
+    size_t functions_analyzed {0};
+    // Files whose keyword bound showed no function can reach the threshold
+    size_t files_prefiltered {0};
+    // Functions not scored since their own keyword bound is below the threshold
+    size_t functions_prefiltered {0};
+    // Files estimated by the fast scanner since parse errors dominated them
+    size_t files_approximated {0};
+    std::array<size_t, static_cast<size_t>(utils::SkipReason::Count)> skipped {};
+    // Admission control under a memory budget; set for the whole run, not
+    // per worker
+    size_t peak_inflight_bytes {0};
+    size_t files_delayed {0};
+    size_t bytes_read {0};
+    size_t functions_found {0};
+    size_t syntax_nodes {0};
+    // Filled in only while timing; summed over workers, so wall time can
+    // exceed that of the run
+    std::array<PhaseTime, static_cast<size_t>(Phase::Count)> phases {};
+    // Set by the caller for the whole run
+    uint64_t run_wall_nanos {0};
+    uint64_t run_cpu_nanos {0};
+
+    void skip(utils::SkipReason reason) { skipped[static_cast<size_t>(reason)]++; }
+    size_t skipped_for(utils::SkipReason reason) const { return skipped[static_cast<size_t>(reason)]; }
+    const PhaseTime &time_of(Phase phase) const { return phases[static_cast<size_t>(phase)]; }
+    void add_time(Phase phase, uint64_t wall_nanos, uint64_t cpu_nanos) {
+        auto &time = phases[static_cast<size_t>(phase)];
+        time.wall_nanos += wall_nanos;
+        time.cpu_nanos += cpu_nanos;
+    }
+
+    void merge(const AnalysisStats &other) {
+        files_analyzed += other.files_analyzed;
+        functions_analyzed += other.functions_analyzed;
+        files_prefiltered += other.files_prefiltered;
+        functions_prefiltered += other.functions_prefiltered;
+        files_approximated += other.files_approximated;
+        peak_inflight_bytes =
+            other.peak_inflight_bytes > peak_inflight_bytes ? other.peak_inflight_bytes : peak_inflight_bytes;
+        files_delayed += other.files_delayed;
+        for (size_t i = 0; i < skipped.size(); ++i) {
+            skipped[i] += other.skipped[i];
+        }
+        bytes_read += other.bytes_read;
+        functions_found += other.functions_found;
+        syntax_nodes += other.syntax_nodes;
+        for (size_t i = 0; i < phases.size(); ++i) {
+            phases[i].wall_nanos += other.phases[i].wall_nanos;
+            phases[i].cpu_nanos += other.phases[i].cpu_nanos;
+        }
+    }
+};
+
+// Adds the wall and thread CPU time of its lifetime, or up to stop(), to a
+// phase; does nothing for null stats so timing can stay in hot paths
+class PhaseTimer {
+public:
+    PhaseTimer(AnalysisStats *stats, Phase phase)
+        : stats_(stats), phase_(phase),
+          wall_start_(stats ? wall_clock_nanos() : 0), cpu_start_(stats ? thread_cpu_nanos() : 0) {}
+    ~PhaseTimer() { stop(); }
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+    void stop() {
+        if (stats_) {
+            stats_->add_time(phase_, wall_clock_nanos() - wall_start_, thread_cpu_nanos() - cpu_start_);
+            stats_ = nullptr;
+        }
+    }
+
+private:
+    AnalysisStats *stats_;
+    Phase phase_;
+    uint64_t wall_start_;
+    uint64_t cpu_start_;
+};
+
+} // namespace catchy::analysis
+
+#endif // CATCHY_ANALYSIS_STATS_HPP
@@ -1,6 +1,7 @@
 #include "cognitive_complexity.hpp"
 #include "utils/safe_conversions.hpp"
 #include <string>
+#include <string_view>
 #include <cstring>
 #include <stack>
 #include <unordered_set>
@@ -40,7 +41,8 @@ ComplexityResult CognitiveComplexity::calculate(TSNode root_node, const std::str
     }
 
     result.nesting_level = 0;
-    analyze_control_flow(body_node, source_code, result);
+    result.language = ts_tree_language(root_node.tree);
+    analyze_control_flow(body_node, source_code, result, 0);
     return result;
 }
 
@@ -62,11 +64,20 @@ std::string CognitiveComplexity::extract_node_text(TSNode node, const std::strin
 }
 
 
-void CognitiveComplexity::analyze_control_flow(TSNode node, const std::string& source_code, ComplexityResult& result) {
+void CognitiveComplexity::analyze_control_flow(TSNode node, const std::string& source_code, ComplexityResult& result,
+                                               size_t depth) {
     if (ts_node_is_null(node)) {
         return;
     }
 
+    // Pathological trees stop the walk instead of exhausting time or stack
+    if (nodes_left_ == 0 || (max_depth_ > 0 && depth > max_depth_)) {
+        result.truncated = true;
+        return;
+    }
+    --nodes_left_;
+    result.nodes_visited++;
+
     try {
         const char* node_type = nullptr;
         try {
@@ -102,7 +113,7 @@ void CognitiveComplexity::analyze_control_flow(TSNode node, const std::string& s
                 // Process the function body for non-nested functions
                 TSNode body = ts_node_child_by_field_name(node, "body", strlen("body"));
                 if (!ts_node_is_null(body)) {
-                    analyze_control_flow(body, source_code, result);
+                    analyze_control_flow(body, source_code, result, depth + 1);
                 }
             }
             return;
@@ -120,19 +131,18 @@ void CognitiveComplexity::analyze_control_flow(TSNode node, const std::string& s
                     if (parent_type && (strcmp(parent_type, "else_clause") == 0 || 
                                       strcmp(parent_type, "elif_clause") == 0)) {
                         is_else_if = true;
-                        increment_for_hybrid(result, "else-if chain", line_number);
+                        increment_for_hybrid(result, node, line_number);
                     }
                 }
             }
 
             if (!is_else_if) {
                 // Base increment for control structure
-                increment_for_structural(result, std::string(node_type), line_number);
+                increment_for_structural(result, node, line_number);
 
                 // Add nesting increment if needed
                 if (increases_nesting_level(node_type) && result.nesting_level > 0) {
-                    increment_for_nesting(result, result.nesting_level,
-                        std::string("Nested ") + node_type, line_number);
+                    increment_for_nesting(result, result.nesting_level, node, line_number);
                 }
             }
         }
@@ -148,7 +158,7 @@ void CognitiveComplexity::analyze_control_flow(TSNode node, const std::string& s
         for (uint32_t i = 0; i < child_count; i++) {
             TSNode child = ts_node_child(node, i);
             if (!ts_node_is_null(child)) {
-                analyze_control_flow(child, source_code, result);
+                analyze_control_flow(child, source_code, result, depth + 1);
             }
         }
 
@@ -162,7 +172,7 @@ void CognitiveComplexity::analyze_control_flow(TSNode node, const std::string& s
 
 
 bool CognitiveComplexity::is_control_structure(const char* type) {
-    static const std::unordered_set<std::string> control_structures = {
+    static const std::unordered_set<std::string_view> control_structures = {
         "if_statement",
         "for_statement",
         "while_statement",
@@ -183,7 +193,7 @@ bool CognitiveComplexity::is_boolean_operator(TSNode node) {
 }
 
 bool CognitiveComplexity::increases_nesting_level(const char* type) {
-    static const std::unordered_set<std::string> nesting_structures = {
+    static const std::unordered_set<std::string_view> nesting_structures = {
         "if_statement",
         "for_statement",
         "while_statement",
@@ -208,65 +218,76 @@ void CognitiveComplexity::analyze_boolean_operators(TSNode node, ComplexityResul
             
             if (strcmp(operator_type, "&&") == 0 || strcmp(operator_type, "||") == 0) {
                 spdlog::debug("Found boolean operator: {} at line {}", operator_type, line_number);
-                increment_for_fundamental(result, 
-                    std::string("Boolean operator: ") + operator_type,
-                    line_number);
+                increment_for_fundamental(result, operator_node, line_number);
             }
         }
     }
 }
 
+void CognitiveComplexity::add_factor(ComplexityResult& result,
+                                     FactorKind kind,
+                                     TSNode node,
+                                     size_t increment,
+                                     size_t line_number) {
+    result.total_complexity += increment;
+    if (record_factors_) {
+        result.factors.push_back({
+            kind,
+            ts_node_symbol(node),
+            static_cast<uint32_t>(increment),
+            static_cast<uint32_t>(line_number)
+        });
+    }
+}
+
 void CognitiveComplexity::increment_for_nesting(ComplexityResult& result, 
                                               size_t nesting_level, 
-                                              const std::string& reason,
+                                              TSNode node,
                                               size_t line_number) {
-    result.total_complexity += nesting_level;
-    result.factors.push_back({
-        reason,
-        nesting_level,
-        line_number
-    });
+    add_factor(result, FactorKind::Nesting, node, nesting_level, line_number);
     spdlog::debug("Added nesting complexity: +{} for {} at line {}", 
-                 nesting_level, reason, line_number);
+                 nesting_level, ts_node_type(node), line_number);
 }
 
 void CognitiveComplexity::increment_for_structural(ComplexityResult& result, 
-                                                 const std::string& reason,
+                                                 TSNode node,
                                                  size_t line_number) {
-    result.total_complexity += 1;
-    result.factors.push_back({
-        reason,
-        1,
-        line_number
-    });
+    add_factor(result, FactorKind::Structural, node, 1, line_number);
     spdlog::debug("Added structural complexity: +1 for {} at line {}", 
-                 reason, line_number);
+                 ts_node_type(node), line_number);
 }
 
 void CognitiveComplexity::increment_for_fundamental(ComplexityResult& result, 
-                                                  const std::string& reason,
+                                                  TSNode node,
                                                   size_t line_number) {
-    result.total_complexity += 1;
-    result.factors.push_back({
-        reason,
-        1,
-        line_number
-    });
+    add_factor(result, FactorKind::Fundamental, node, 1, line_number);
     spdlog::debug("Added fundamental complexity: +1 for {} at line {}", 
-                 reason, line_number);
+                 ts_node_type(node), line_number);
 }
 
 void CognitiveComplexity::increment_for_hybrid(ComplexityResult& result, 
-                                             const std::string& reason,
+                                             TSNode node,
                                              size_t line_number) {
-    result.total_complexity += 1;
-    result.factors.push_back({
-        reason,
-        1,
-        line_number
-    });
+    add_factor(result, FactorKind::Hybrid, node, 1, line_number);
     spdlog::debug("Added hybrid complexity: +1 for {} at line {}", 
-                 reason, line_number);
+                 ts_node_type(node), line_number);
+}
+
+std::string ComplexityFactor::describe(const TSLanguage* language) const {
+    const char* node_type = language ? ts_language_symbol_name(language, symbol) : nullptr;
+    std::string type = node_type ? node_type : "unknown";
+
+    switch (kind) {
+        case FactorKind::Nesting:
+            return "Nested " + type;
+        case FactorKind::Fundamental:
+            return "Boolean operator: " + type;
+        case FactorKind::Hybrid:
+            return "else-if chain";
+        case FactorKind::Structural:
+        default:
+            return type;
+    }
 }
 
 } // namespace catchy::complexity
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <tree_sitter/api.h>
@@ -12,16 +13,31 @@
 
 namespace catchy::complexity {
 
+enum class FactorKind : uint8_t {
+    Structural,
+    Nesting,
+    Fundamental,
+    Hybrid
+};
+
+// Compact record of a single increment; the text is only rendered on demand
 struct ComplexityFactor {
-    std::string description;
-    size_t increment;
-    size_t line_number;
+    FactorKind kind;
+    TSSymbol symbol;
+    uint32_t increment;
+    uint32_t line_number;
+
+    std::string describe(const TSLanguage *language) const;
 };
 
 struct ComplexityResult {
     size_t total_complexity{0};
     size_t nesting_level{0};
     std::vector<ComplexityFactor> factors;
+    const TSLanguage *language{nullptr};
+    // The walk stopped at the node budget or depth limit; the total is partial
+    bool truncated{false};
+    size_t nodes_visited{0};
     
     // Add map to track per-function complexity
     std::map<std::string, size_t> function_complexities;
@@ -36,19 +52,36 @@ public:
     }
     ComplexityResult calculate(TSNode root_node, const std::string &source_code);
 
+    // By default only total_complexity is computed; when recording, every
+    // increment is also stored in ComplexityResult::factors
+    void set_record_factors(bool record) { record_factors_ = record; }
+
+    // Nodes the scoring walk may still visit, shared by all following
+    // calls until reset; zero for no limit
+    void set_node_budget(size_t nodes) { nodes_left_ = nodes ? nodes : SIZE_MAX; }
+    // The remaining count as is: zero when exhausted and SIZE_MAX without a
+    // limit, so saving and restoring it keeps an exhausted budget exhausted
+    size_t nodes_left() const { return nodes_left_; }
+    void set_nodes_left(size_t nodes) { nodes_left_ = nodes; }
+    // Deepest node below a function's body the walk descends to; zero for no limit
+    void set_max_depth(size_t depth) { max_depth_ = depth; }
+
 private:
     std::unique_ptr<TSParser, void(*)(TSParser*)> parser_{nullptr, ts_parser_delete};
     std::unique_ptr<TSTree, void(*)(TSTree*)> tree_{nullptr, ts_tree_delete};
+    bool record_factors_{false};
+    size_t nodes_left_{SIZE_MAX};
+    size_t max_depth_{0};
+
     // Increment complexity based on different factors
-    void increment_for_nesting(ComplexityResult& result, size_t increment, const std::string& reason, size_t line_number);
-    void increment_for_structural(ComplexityResult& result, const std::string& reason, size_t line_number);
-    void increment_for_fundamental(ComplexityResult& result, const std::string& reason, size_t line_number);
-    void increment_for_hybrid(ComplexityResult& result, 
-                                             const std::string& reason,
-                                             size_t line_number);
+    void increment_for_nesting(ComplexityResult& result, size_t increment, TSNode node, size_t line_number);
+    void increment_for_structural(ComplexityResult& result, TSNode node, size_t line_number);
+    void increment_for_fundamental(ComplexityResult& result, TSNode node, size_t line_number);
+    void increment_for_hybrid(ComplexityResult& result, TSNode node, size_t line_number);
+    void add_factor(ComplexityResult& result, FactorKind kind, TSNode node, size_t increment, size_t line_number);
 
     // Analyze specific structures
-    void analyze_control_flow(TSNode node, const std::string& source_code, ComplexityResult& result);
+    void analyze_control_flow(TSNode node, const std::string& source_code, ComplexityResult& result, size_t depth);
     void analyze_boolean_operators(TSNode node, ComplexityResult& result);
     void analyze_exceptions(TSNode node, ComplexityResult& result);
     void analyze_switch(TSNode node, ComplexityResult& result);
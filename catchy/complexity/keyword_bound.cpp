@@ -0,0 +1,133 @@
+#include "keyword_bound.hpp"
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace catchy::complexity {
+
+namespace {
+
+// Keywords of the nodes CognitiveComplexity::is_control_structure accepts
+constexpr std::string_view cpp_keywords[] = {"if", "else", "for", "while", "do", "catch", "case", "default"};
+constexpr std::string_view python_keywords[] = {"if", "elif", "else", "for", "while"};
+
+// Letters and '_' can make a keyword part of a longer identifier. Digits
+// only do so after it: Python accepts "1if x else y".
+inline bool continues_word_before(unsigned char c) {
+    return c == '_' || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+}
+
+inline bool continues_word_after(unsigned char c) {
+    return continues_word_before(c) || (c >= '0' && c <= '9');
+}
+
+inline bool is_first_letter(unsigned char c) {
+    return c == 'i' || c == 'e' || c == 'f' || c == 'w' || c == 'd' || c == 'c';
+}
+
+class KeywordCounter {
+public:
+    KeywordCounter(std::string_view source, const std::string_view *keywords, size_t keyword_count, size_t limit)
+        : source_(source), keywords_(keywords), keyword_count_(keyword_count), limit_(limit) {}
+
+    size_t count() {
+        const auto* data = reinterpret_cast<const unsigned char*>(source_.data());
+        size_t size = source_.size();
+        size_t i = 0;
+        bool previous_continues = false;
+
+#if defined(__SSE2__)
+        // Flag word starts beginning with a keyword's first letter, 16 bytes
+        // at a time; only those positions are compared against the keywords
+        const __m128i case_bit = _mm_set1_epi8(0x20);
+        const __m128i before_a = _mm_set1_epi8('a' - 1);
+        const __m128i after_z = _mm_set1_epi8('z' + 1);
+        const __m128i underscore = _mm_set1_epi8('_');
+        for (; i + 16 <= size; i += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            // Bytes >= 0x80 compare as negative and never count as letters
+            __m128i folded = _mm_or_si128(bytes, case_bit);
+            __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(folded, before_a), _mm_cmplt_epi8(folded, after_z));
+            __m128i word = _mm_or_si128(letters, _mm_cmpeq_epi8(bytes, underscore));
+
+            __m128i first = _mm_setzero_si128();
+            for (char c : {'i', 'e', 'f', 'w', 'd', 'c'}) {
+                first = _mm_or_si128(first, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(c)));
+            }
+
+            auto word_mask = static_cast<uint32_t>(_mm_movemask_epi8(word));
+            auto first_mask = static_cast<uint32_t>(_mm_movemask_epi8(first));
+            uint32_t preceded = (word_mask << 1) | (previous_continues ? 1u : 0u);
+            uint32_t candidates = first_mask & ~preceded & 0xffff;
+            previous_continues = (word_mask >> 15) & 1;
+
+            while (candidates) {
+                if (matches_at(i + static_cast<size_t>(__builtin_ctz(candidates))) && ++found_ >= limit_) {
+                    return found_;
+                }
+                candidates &= candidates - 1;
+            }
+        }
+#endif
+
+        for (; i < size; ++i) {
+            unsigned char c = data[i];
+            if (is_first_letter(c) && !previous_continues && matches_at(i) && ++found_ >= limit_) {
+                return found_;
+            }
+            previous_continues = continues_word_before(c);
+        }
+        return found_;
+    }
+
+private:
+    bool matches_at(size_t pos) const {
+        std::string_view rest = source_.substr(pos);
+        for (size_t k = 0; k < keyword_count_; ++k) {
+            const auto& keyword = keywords_[k];
+            if (rest.size() >= keyword.size() &&
+                std::memcmp(rest.data(), keyword.data(), keyword.size()) == 0 &&
+                (rest.size() == keyword.size() ||
+                 !continues_word_after(static_cast<unsigned char>(rest[keyword.size()])))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string_view source_;
+    const std::string_view* keywords_;
+    size_t keyword_count_;
+    size_t limit_;
+    size_t found_ {0};
+};
+
+} // namespace
+
+size_t count_control_keywords(std::string_view source, const std::string& language, size_t limit) {
+    if (limit == 0) {
+        return 0;
+    }
+    if (language == "cpp") {
+        return KeywordCounter(source, cpp_keywords, std::size(cpp_keywords), limit).count();
+    }
+    if (language == "python") {
+        return KeywordCounter(source, python_keywords, std::size(python_keywords), limit).count();
+    }
+    return limit;
+}
+
+bool may_reach_threshold(std::string_view source, const std::string& language, size_t threshold) {
+    // Fewest keywords whose bound reaches the threshold
+    size_t needed = 0;
+    while (complexity_upper_bound(needed) < threshold) {
+        ++needed;
+    }
+    return count_control_keywords(source, language, needed) >= needed;
+}
+
+} // namespace catchy::complexity
@@ -0,0 +1,36 @@
+#ifndef CATCHY_COMPLEXITY_KEYWORD_BOUND_HPP
+#define CATCHY_COMPLEXITY_KEYWORD_BOUND_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace catchy::complexity {
+
+// Lexical upper bound on the cognitive complexity of any function in a
+// source buffer, computed without parsing.
+//
+// Every node CognitiveComplexity scores (if, else, elif, for, while, do,
+// catch, case/default) contains its keyword token, and only those nodes add
+// nesting. With k keyword occurrences, a function has at most k scored
+// nodes and the i-th is nested at most i - 1 deep, so no function scores
+// more than k(k+1)/2. Keywords in comments and strings only loosen the
+// bound.
+
+// Occurrences of the scored keywords of `language`, counting no further
+// than `limit`. Unknown languages report `limit`.
+size_t count_control_keywords(std::string_view source, const std::string &language, size_t limit);
+
+inline uint64_t complexity_upper_bound(size_t keywords) {
+    return static_cast<uint64_t>(keywords) * (keywords + 1) / 2;
+}
+
+// False only if no function in `source` can reach `threshold`
+bool may_reach_threshold(std::string_view source, const std::string &language, size_t threshold);
+
+} // namespace catchy::complexity
+
+#endif // CATCHY_COMPLEXITY_KEYWORD_BOUND_HPP
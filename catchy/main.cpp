@@ -1,12 +1,24 @@
 #include "analysis/analyzer.hpp"
+#include "analysis/project_config.hpp"
+#include "analysis/snapshot.hpp"
 #include "parser/parser_factory.hpp"
 #include "utils/filesystem.hpp"
 #include "utils/git.hpp"
+#include <fmt/format.h>
 #include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
 #include <llvm/Support/InitLLVM.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/Signals.h>
 #include <llvm/Support/raw_ostream.h>
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <filesystem>
+#include <functional>
+#include <optional>
+#include <type_traits>
 #include <vector>
 #include <tabulate/table.hpp>
 
@@ -28,22 +40,194 @@ static cl::opt<unsigned> Threshold(
     cl::init(0),
     cl::cat(CatchyCategory));
 
+static cl::opt<catchy::analysis::ScoringMode> Mode(
+    "mode",
+    cl::desc("How functions are scored (default: exact)"),
+    cl::values(
+        clEnumValN(catchy::analysis::ScoringMode::Exact, "exact", "Parse with tree-sitter"),
+        clEnumValN(catchy::analysis::ScoringMode::Fast, "fast", "Estimate from a token scan, without parsing")),
+    cl::init(catchy::analysis::ScoringMode::Exact),
+    cl::cat(CatchyCategory));
+
 static cl::opt<bool> Recursive(
     "recursive",
     cl::desc("Recursively analyze directories"),
     cl::init(false),
     cl::cat(CatchyCategory));
 
+static cl::opt<unsigned> Jobs(
+    "jobs",
+    cl::desc("Number of threads walking and analyzing files (default: 1)"),
+    cl::init(1),
+    cl::cat(CatchyCategory));
+
+static cl::opt<bool> PruneDefaults(
+    "prune-defaults",
+    cl::desc("Skip vendored and build directories such as .git, build and node_modules (default: true)"),
+    cl::init(true),
+    cl::cat(CatchyCategory));
+
+static cl::opt<bool> RespectIgnoreFiles(
+    "respect-ignore-files",
+    cl::desc("Skip paths excluded by .gitignore, .git/info/exclude and .catchyignore (default: true)"),
+    cl::init(true),
+    cl::cat(CatchyCategory));
+
+static cl::list<std::string> Ignore(
+    "ignore",
+    cl::desc("Skip paths matching a glob pattern (repeatable, comma separated)"),
+    cl::value_desc("pattern"),
+    cl::CommaSeparated,
+    cl::cat(CatchyCategory));
+
+static cl::opt<bool> Rollup(
+    "rollup",
+    cl::desc("Print per-directory complexity totals as a tree"),
+    cl::init(false),
+    cl::cat(CatchyCategory));
+
+static cl::opt<unsigned> Depth(
+    "depth",
+    cl::desc("Maximum directory depth of the rollup report (default: 0, unlimited)"),
+    cl::init(0),
+    cl::cat(CatchyCategory));
+
+static cl::opt<bool> AggregateOnly(
+    "aggregate-only",
+    cl::desc("Only report per-file and per-directory totals"),
+    cl::init(false),
+    cl::cat(CatchyCategory));
+
+static cl::opt<bool> Explain(
+    "explain",
+    cl::desc("Show each complexity increment of functions over the threshold"),
+    cl::init(false),
+    cl::cat(CatchyCategory));
+
+static cl::opt<std::string> Snapshot(
+    "snapshot",
+    cl::desc("Save the results as a sorted NDJSON snapshot for `catchy diff`"),
+    cl::value_desc("file"),
+    cl::init(""),
+    cl::cat(CatchyCategory));
+
+static cl::opt<bool> Sniff(
+    "sniff",
+    cl::desc("Skip binary, generated and minified files (default: true)"),
+    cl::init(true),
+    cl::cat(CatchyCategory));
+
+static cl::opt<bool> Prefilter(
+    "prefilter",
+    cl::desc("Skip files and functions whose keyword count shows they cannot reach the threshold (default: true)"),
+    cl::init(true),
+    cl::cat(CatchyCategory));
+
+static cl::opt<unsigned> ParseTimeout(
+    "parse-timeout",
+    cl::desc("Skip files taking longer than this many milliseconds to parse (default: 10000, 0 for no limit)"),
+    cl::value_desc("ms"),
+    cl::init(10000),
+    cl::cat(CatchyCategory));
+
+static cl::opt<unsigned> MaxNodes(
+    "max-nodes",
+    cl::desc("Skip files whose functions span more syntax nodes than this (default: 10000000, 0 for no limit)"),
+    cl::init(10000000),
+    cl::cat(CatchyCategory));
+
+static cl::opt<unsigned> MaxDepth(
+    "max-depth",
+    cl::desc("Skip files with syntax nested deeper than this inside a function (default: 5000, 0 for no limit)"),
+    cl::init(5000),
+    cl::cat(CatchyCategory));
+
+static cl::opt<unsigned> MaxErrorPercent(
+    "max-error-percent",
+    cl::desc("Estimate files whose parse errors cover more than this share of their bytes "
+             "with the fast scanner (default: 30, 100 to never fall back)"),
+    cl::init(30),
+    cl::cat(CatchyCategory));
+
+static cl::opt<bool> UseArena(
+    "arena",
+    cl::desc("Allocate each file's syntax tree and scratch memory from a per-thread arena (default: true)"),
+    cl::init(true),
+    cl::cat(CatchyCategory));
+
+static cl::opt<unsigned> MemoryLimit(
+    "memory-limit",
+    cl::desc("Keep at most this many MiB of results in memory and spill the rest to sorted temporary "
+             "files; reports are then merged from them in path order (default: 0, no limit)"),
+    cl::value_desc("MiB"),
+    cl::init(0),
+    cl::cat(CatchyCategory));
+
+static cl::opt<unsigned long long> MaxInflightBytes(
+    "max-inflight-bytes",
+    cl::desc("Only start on a file while the estimated memory of the files being analyzed stays under "
+             "this many bytes (default: 0, no limit)"),
+    cl::value_desc("bytes"),
+    cl::init(0),
+    cl::cat(CatchyCategory));
+
+static cl::opt<bool> Stats(
+    "stats",
+    cl::desc("Print counters of analyzed and skipped files, time per phase and throughput"),
+    cl::init(false),
+    cl::cat(CatchyCategory));
+
+static cl::opt<std::string> StatsJson(
+    "stats-json",
+    cl::desc("Write the --stats counters and times as JSON to this file ('-' for standard output)"),
+    cl::value_desc("file"),
+    cl::init(""),
+    cl::cat(CatchyCategory));
+
+static cl::opt<std::string> ConfigFile(
+    "config",
+    cl::desc("Project config file (default: the nearest .catchy.toml)"),
+    cl::value_desc("file"),
+    cl::init(""),
+    cl::cat(CatchyCategory));
+
+static cl::opt<bool> NoConfig(
+    "no-config",
+    cl::desc("Do not look for a .catchy.toml"),
+    cl::init(false),
+    cl::cat(CatchyCategory));
+
 static cl::opt<bool> Verbose(
     "verbose",
     cl::desc("Enable verbose output"),
     cl::init(false),
     cl::cat(CatchyCategory));
 
-// Function to display results using Tabulate
-void display_results(const std::vector<catchy::analysis::AnalysisResult>& results) {
-    using catchy::analysis::AnalysisResult;
+// Compare two snapshots saved with --snapshot
+static cl::SubCommand DiffCommand("diff", "Compare two result snapshots");
 
+static cl::opt<std::string> DiffOld(
+    cl::Positional,
+    cl::desc("<old snapshot>"),
+    cl::Required,
+    cl::sub(DiffCommand),
+    cl::cat(CatchyCategory));
+
+static cl::opt<std::string> DiffNew(
+    cl::Positional,
+    cl::desc("<new snapshot>"),
+    cl::Required,
+    cl::sub(DiffCommand),
+    cl::cat(CatchyCategory));
+
+// Rows reported so far, for the summary after the last results table
+struct ResultTotals {
+    size_t complexity {0};
+    std::unordered_map<catchy::utils::InternedString, size_t> per_file;
+};
+
+// Function to display results using Tabulate
+void display_results(const catchy::analysis::ResultStore& results, ResultTotals& totals) {
     Table table;
 
     // Add headers
@@ -53,21 +237,28 @@ void display_results(const std::vector<catchy::analysis::AnalysisResult>& result
         .font_align(FontAlign::center)
         .font_background_color(Color::cyan);
 
-    size_t total_complexity = 0;
-    std::unordered_map<std::string, size_t> complexity_per_file;
-
-    // Add rows with results
-    for (const auto& result : results) {
-        std::string file_name = std::filesystem::path(result.file_path).filename().string();
+    // Add rows with results; those of one file are adjacent, so its name is
+    // only split off once
+    catchy::utils::InternedString last_path;
+    std::string file_name;
+    for (auto result : results) {
+        if (result.below_threshold()) {
+            continue;
+        }
+        if (result.file_path() != last_path) {
+            last_path = result.file_path();
+            file_name = std::filesystem::path(last_path.str()).filename().string();
+        }
         table.add_row({
-            result.file_path,
+            last_path.str(),
             file_name,
-            result.function_name,
-            std::to_string(result.complexity)
+            std::string(result.function_name()),
+            // Estimates from files tree-sitter could not parse cleanly
+            (result.approximate() ? "~" : "") + std::to_string(result.complexity())
         });
 
-        total_complexity += result.complexity;
-        complexity_per_file[result.file_path] += result.complexity;
+        totals.complexity += result.complexity();
+        totals.per_file[last_path] += result.complexity();
     }
 
     // Format rows
@@ -77,16 +268,265 @@ void display_results(const std::vector<catchy::analysis::AnalysisResult>& result
 
     // Print the table
     std::cout << table << std::endl;
+}
 
-    // Display summary
+void display_summary(const ResultTotals& totals) {
     std::cout << "\nSummary:\n";
-    if (complexity_per_file.size() > 1) {
-        std::cout << "Files analyzed: " << complexity_per_file.size() << "\n";
+    if (totals.per_file.size() > 1) {
+        std::cout << "Files analyzed: " << totals.per_file.size() << "\n";
     }
-    for (const auto& [file, complexity] : complexity_per_file) {
+    for (const auto& [file, complexity] : totals.per_file) {
         std::cout << "Total for file " << file << ": " << complexity << "\n";
     }
-    std::cout << "Total complexity for all files: " << total_complexity << "\n";
+    std::cout << "Total complexity for all files: " << totals.complexity << "\n";
+}
+
+// Function to display why each reported function scored what it did
+void display_explanations(const catchy::analysis::ResultStore& results) {
+    for (auto result : results) {
+        auto factors = result.factors();
+        if (factors.empty() || result.below_threshold()) {
+            continue;
+        }
+
+        std::cout << result.file_path() << ":" << result.start_line() << " "
+                  << result.function_name() << " (complexity " << result.complexity() << ")\n";
+        for (size_t i = 0; i < factors.size(); ++i) {
+            const auto& factor = factors[i];
+            std::string description = factor.describe(result.grammar());
+            std::cout << "  line " << factor.line_number
+                      << "  +" << factor.increment
+                      << "  " << description;
+            if (result.has_snippets()) {
+                std::cout << std::string(description.size() < 28 ? 28 - description.size() : 1, ' ')
+                          << result.snippet(i);
+            }
+            std::cout << "\n";
+        }
+    }
+}
+
+// Function to display per-directory totals as a tree
+void display_rollup(catchy::analysis::PathTrie& rollup, size_t max_depth) {
+    using catchy::analysis::PathTrie;
+
+    rollup.finalize();
+
+    Table table;
+    table.add_row({"Path", "Files", "Functions", "Total", "Max", "Over threshold"});
+    table[0].format()
+        .font_style({FontStyle::bold})
+        .font_align(FontAlign::center)
+        .font_background_color(Color::cyan);
+
+    // Whether the ancestor at each depth was the last of its siblings
+    std::vector<bool> last_at_depth;
+    rollup.visit(max_depth, [&](const PathTrie::Node& node, size_t depth, bool last) {
+        last_at_depth.resize(depth + 1);
+        last_at_depth[depth] = last;
+
+        std::string prefix;
+        for (size_t i = 1; i < depth; ++i) {
+            prefix += last_at_depth[i] ? "    " : "│   ";
+        }
+        if (depth > 0) {
+            prefix += last ? "└── " : "├── ";
+        }
+
+        const auto& stats = node.total;
+        table.add_row({
+            prefix + node.name + (node.is_file || depth == 0 ? "" : "/"),
+            std::to_string(stats.files),
+            std::to_string(stats.functions),
+            std::to_string(stats.sum),
+            std::to_string(stats.max),
+            std::to_string(stats.over_threshold)
+        });
+    });
+
+    for (size_t i = 1; i < table.size(); ++i) {
+        table[i].format().font_align(FontAlign::left);
+    }
+
+    std::cout << "\nRollup:\n" << table << std::endl;
+}
+
+double per_second(size_t count, uint64_t nanos) {
+    return nanos ? static_cast<double>(count) * 1e9 / static_cast<double>(nanos) : 0.0;
+}
+
+std::string format_seconds(uint64_t nanos) {
+    return fmt::format("{:.3f} s", static_cast<double>(nanos) / 1e9);
+}
+
+void display_phases(const catchy::analysis::AnalysisStats& stats) {
+    using catchy::analysis::Phase;
+
+    Table table;
+    table.add_row({"Phase", "Wall (all threads)", "CPU", "Share of CPU"});
+    table[0].format()
+        .font_style({FontStyle::bold})
+        .font_align(FontAlign::center)
+        .font_background_color(Color::cyan);
+
+    uint64_t cpu_nanos = 0;
+    for (const auto& time : stats.phases) {
+        cpu_nanos += time.cpu_nanos;
+    }
+    for (size_t i = 0; i < static_cast<size_t>(Phase::Count); ++i) {
+        const auto& time = stats.phases[i];
+        std::string name = catchy::analysis::describe(static_cast<Phase>(i));
+        name[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(name[0])));
+        table.add_row({name, format_seconds(time.wall_nanos), format_seconds(time.cpu_nanos),
+                       fmt::format("{:.1f}%", cpu_nanos ? 100.0 * static_cast<double>(time.cpu_nanos) /
+                                                              static_cast<double>(cpu_nanos)
+                                                        : 0.0)});
+    }
+
+    std::cout << "\nPhases:\n" << table << std::endl;
+}
+
+void display_stats(const catchy::analysis::AnalysisStats& stats) {
+    using catchy::utils::SkipReason;
+
+    Table table;
+    table.add_row({"Statistic", "Count"});
+    table[0].format()
+        .font_style({FontStyle::bold})
+        .font_align(FontAlign::center)
+        .font_background_color(Color::cyan);
+
+    table.add_row({"Files analyzed", std::to_string(stats.files_analyzed)});
+    table.add_row({"Functions analyzed", std::to_string(stats.functions_analyzed)});
+    table.add_row({"Skipped (below threshold)", std::to_string(stats.files_prefiltered)});
+    table.add_row({"Functions skipped (below threshold)", std::to_string(stats.functions_prefiltered)});
+    table.add_row({"Files estimated (parse errors)", std::to_string(stats.files_approximated)});
+    for (size_t i = 1; i < static_cast<size_t>(SkipReason::Count); ++i) {
+        auto reason = static_cast<SkipReason>(i);
+        table.add_row({std::string("Skipped (") + catchy::utils::describe(reason) + ")",
+                       std::to_string(stats.skipped_for(reason))});
+    }
+    if (stats.peak_inflight_bytes > 0) {
+        table.add_row({"Peak in-flight bytes (estimated)", std::to_string(stats.peak_inflight_bytes)});
+        table.add_row({"Files delayed (memory budget)", std::to_string(stats.files_delayed)});
+    }
+    table.add_row({"Bytes read", std::to_string(stats.bytes_read)});
+    table.add_row({"Functions found", std::to_string(stats.functions_found)});
+    table.add_row({"Syntax nodes scored", std::to_string(stats.syntax_nodes)});
+    table.add_row({"Wall time", format_seconds(stats.run_wall_nanos)});
+    table.add_row({"CPU time", format_seconds(stats.run_cpu_nanos)});
+    table.add_row({"Files/s", fmt::format("{:.1f}", per_second(stats.files_analyzed, stats.run_wall_nanos))});
+    table.add_row({"Functions/s",
+                   fmt::format("{:.1f}", per_second(stats.functions_analyzed, stats.run_wall_nanos))});
+    table.add_row({"MiB/s", fmt::format("{:.2f}", per_second(stats.bytes_read, stats.run_wall_nanos) / (1 << 20))});
+
+    std::cout << "\nStatistics:\n" << table << std::endl;
+    display_phases(stats);
+}
+
+// The --stats counters and times, with rates over the run's wall time
+void write_stats_json(const catchy::analysis::AnalysisStats& stats, const std::string& path) {
+    using catchy::analysis::Phase;
+    using catchy::utils::SkipReason;
+
+    std::optional<raw_fd_ostream> file;
+    if (path != "-") {
+        std::error_code error;
+        file.emplace(path, error, sys::fs::OF_Text);
+        if (error) {
+            throw std::runtime_error("Cannot write " + path + ": " + error.message());
+        }
+    }
+    raw_ostream& out = file ? static_cast<raw_ostream&>(*file) : outs();
+    auto seconds = [](uint64_t nanos) { return static_cast<double>(nanos) / 1e9; };
+
+    json::OStream json(out, 2);
+    json.object([&] {
+        json.attribute("files_analyzed", int64_t(stats.files_analyzed));
+        json.attribute("functions_analyzed", int64_t(stats.functions_analyzed));
+        json.attribute("functions_found", int64_t(stats.functions_found));
+        json.attribute("files_prefiltered", int64_t(stats.files_prefiltered));
+        json.attribute("functions_prefiltered", int64_t(stats.functions_prefiltered));
+        json.attribute("files_approximated", int64_t(stats.files_approximated));
+        json.attribute("bytes_read", int64_t(stats.bytes_read));
+        json.attribute("syntax_nodes", int64_t(stats.syntax_nodes));
+        json.attribute("peak_inflight_bytes", int64_t(stats.peak_inflight_bytes));
+        json.attribute("files_delayed", int64_t(stats.files_delayed));
+        json.attributeObject("skipped", [&] {
+            for (size_t i = 1; i < static_cast<size_t>(SkipReason::Count); ++i) {
+                auto reason = static_cast<SkipReason>(i);
+                json.attribute(catchy::utils::identifier(reason), int64_t(stats.skipped_for(reason)));
+            }
+        });
+        json.attribute("wall_seconds", seconds(stats.run_wall_nanos));
+        json.attribute("cpu_seconds", seconds(stats.run_cpu_nanos));
+        json.attribute("files_per_second", per_second(stats.files_analyzed, stats.run_wall_nanos));
+        json.attribute("functions_per_second", per_second(stats.functions_analyzed, stats.run_wall_nanos));
+        json.attribute("bytes_per_second", per_second(stats.bytes_read, stats.run_wall_nanos));
+        json.attributeObject("phases", [&] {
+            for (size_t i = 0; i < static_cast<size_t>(Phase::Count); ++i) {
+                const auto& time = stats.phases[i];
+                json.attributeObject(catchy::analysis::describe(static_cast<Phase>(i)), [&] {
+                    json.attribute("wall_seconds", seconds(time.wall_nanos));
+                    json.attribute("cpu_seconds", seconds(time.cpu_nanos));
+                });
+            }
+        });
+    });
+    json.flush();
+    out << "\n";
+}
+
+// Function to stream the differences between two snapshots; returns 1 if a
+// function got worse
+int run_diff(const std::string& old_path, const std::string& new_path) {
+    using catchy::analysis::DiffKind;
+    using catchy::analysis::SnapshotRecord;
+
+    auto describe = [](const SnapshotRecord& record) {
+        return record.file_path + ":" + std::to_string(record.start_line) + " " + record.function_name +
+               (record.approximate ? " [approximate]" : "");
+    };
+
+    auto summary = catchy::analysis::diff_snapshots(old_path, new_path,
+        [&](DiffKind kind, const SnapshotRecord* old_record, const SnapshotRecord* new_record) {
+            switch (kind) {
+                case DiffKind::Added:
+                    std::cout << "added     " << describe(*new_record)
+                              << " (" << new_record->complexity << ")\n";
+                    break;
+                case DiffKind::Removed:
+                    std::cout << "removed   " << describe(*old_record)
+                              << " (" << old_record->complexity << ")\n";
+                    break;
+                case DiffKind::Worsened:
+                case DiffKind::Improved:
+                    std::cout << (kind == DiffKind::Worsened ? "worsened  " : "improved  ")
+                              << describe(*new_record) << " (" << old_record->complexity
+                              << " -> " << new_record->complexity << ")\n";
+                    break;
+            }
+        });
+
+    std::cout << "\nSummary:\n"
+              << "Added: " << summary.added << "\n"
+              << "Removed: " << summary.removed << "\n"
+              << "Worsened: " << summary.worsened << "\n"
+              << "Improved: " << summary.improved << "\n"
+              << "Unchanged: " << summary.unchanged << "\n";
+    return summary.worsened > 0 ? 1 : 0;
+}
+
+// Rows per results table when reporting spilled results
+constexpr size_t report_batch_rows = 10000;
+
+// Set while analyzing so Ctrl-C stops a stuck parse and prints what was found
+static std::atomic<size_t>* CancellationFlag = nullptr;
+
+static void cancel_analysis() {
+    if (CancellationFlag) {
+        CancellationFlag->store(1, std::memory_order_relaxed);
+    }
 }
 
 int main(int argc, char **argv) {
@@ -103,13 +543,97 @@ int main(int argc, char **argv) {
     cl::HideUnrelatedOptions(CatchyCategory);
     cl::ParseCommandLineOptions(argc, argv, "Catchy - Cognitive Complexity Analyzer\n");
 
+    if (DiffCommand) {
+        try {
+            return run_diff(DiffOld, DiffNew);
+        } catch (const std::exception& e) {
+            spdlog::error("Failed to diff snapshots: {}", e.what());
+            return 2;
+        }
+    }
+
     try {
+        using catchy::analysis::ProjectConfig;
+        std::shared_ptr<const ProjectConfig> config;
+        std::optional<std::string> config_path;
+        if (!ConfigFile.empty()) {
+            config_path = ConfigFile.getValue();
+        } else if (!NoConfig) {
+            config_path = ProjectConfig::find(InputPath);
+        }
+        if (config_path) {
+            spdlog::info("Using config: {}", *config_path);
+            config = std::make_shared<const ProjectConfig>(ProjectConfig::load(*config_path));
+        }
+
+        // Options given on the command line win over the config file
+        auto setting = [](const auto& option, const auto& configured) {
+            using Value = std::decay_t<decltype(option.getValue())>;
+            if (option.getNumOccurrences() || !configured) {
+                return Value(option.getValue());
+            }
+            return Value(*configured);
+        };
+        catchy::analysis::OutputSettings output;
+        std::optional<size_t> configured_threshold;
+        if (config) {
+            output = config->output();
+            configured_threshold = config->threshold();
+        }
+        bool rollup = setting(Rollup, output.rollup);
+        bool aggregate_only = setting(AggregateOnly, output.aggregate_only);
+        bool explain = setting(Explain, output.explain);
+        unsigned depth = setting(Depth, output.depth);
+        std::string snapshot = setting(Snapshot, output.snapshot);
+        catchy::analysis::LimitSettings configured_limits;
+        if (config) {
+            configured_limits = config->limits();
+        }
+        catchy::analysis::ParseLimits limits;
+        limits.timeout_micros = uint64_t{setting(ParseTimeout, configured_limits.parse_timeout_ms)} * 1000;
+        limits.max_nodes = setting(MaxNodes, configured_limits.max_nodes);
+        limits.max_depth = setting(MaxDepth, configured_limits.max_depth);
+        limits.max_error_percent = setting(MaxErrorPercent, configured_limits.max_error_percent);
+        size_t memory_limit_mb = setting(MemoryLimit, configured_limits.memory_limit_mb);
+        size_t max_inflight_bytes = setting(MaxInflightBytes, configured_limits.max_inflight_bytes);
+        if (explain && Mode == catchy::analysis::ScoringMode::Fast) {
+            spdlog::warn("--explain is not supported with --mode=fast");
+            explain = false;
+        }
+
         // Initialize analyzer
         catchy::analysis::Analyzer analyzer;
-        analyzer.set_complexity_threshold(Threshold);
+        analyzer.set_complexity_threshold(setting(Threshold, configured_threshold));
+        analyzer.set_threshold_overrides_config(Threshold.getNumOccurrences() > 0);
+        analyzer.set_mode(Mode);
+        analyzer.set_limits(limits);
+        analyzer.set_use_arena(UseArena);
+        analyzer.set_memory_limit(memory_limit_mb << 20);
+        analyzer.set_max_inflight_bytes(max_inflight_bytes);
+        analyzer.set_project_config(config);
+        analyzer.set_jobs(std::max(1u, Jobs.getValue()));
+        analyzer.set_prune_directories(PruneDefaults);
+        analyzer.set_respect_ignore_files(RespectIgnoreFiles);
+        if (!Ignore.empty()) {
+            analyzer.set_ignore_patterns(std::vector<std::string>(Ignore.begin(), Ignore.end()));
+        }
+        analyzer.set_sniff_content(Sniff);
+        analyzer.set_prefilter(Prefilter);
+        analyzer.set_rollup_enabled(rollup);
+        analyzer.set_aggregate_only(aggregate_only);
+        analyzer.set_keep_below_threshold(!snapshot.empty());
+        analyzer.set_explain(explain && !aggregate_only);
+        bool timing = Stats || !StatsJson.empty();
+        analyzer.set_timing(timing);
+
+        CancellationFlag = analyzer.cancellation_flag();
+        sys::SetInterruptFunction(cancel_analysis);
+
+        uint64_t run_wall_start = catchy::analysis::wall_clock_nanos();
+        uint64_t run_cpu_start = catchy::analysis::process_cpu_nanos();
 
         // Analyze based on input type
-        std::vector<catchy::analysis::AnalysisResult> results;
+        catchy::analysis::ResultStore results;
         std::filesystem::path input_path(InputPath.getValue());
 
         if (std::filesystem::is_regular_file(input_path)) {
@@ -127,9 +651,76 @@ int main(int argc, char **argv) {
             spdlog::error("Invalid input path: {}", input_path.string());
             return 1;
         }
+        // A second Ctrl-C terminates as usual
+        sys::SetInterruptFunction(nullptr);
+        bool cancelled = analyzer.cancelled();
+        if (cancelled) {
+            spdlog::warn("Analysis cancelled; results are incomplete");
+        }
+
+        // Results over the memory limit are reported from a merge of the
+        // spilled runs, one bounded batch at a time
+        auto spill = analyzer.spill();
+        auto for_each_batch = [&](const std::function<void(const catchy::analysis::ResultStore&)>& visit) {
+            if (spill && spill->runs() > 0) {
+                spill->merge(results, report_batch_rows, visit);
+            } else {
+                visit(results);
+            }
+        };
+        if (spill && spill->runs() > 0) {
+            spdlog::info("Merging {} spilled results from {} runs", spill->spilled_rows(), spill->runs());
+        }
+
+        // Rendering is timed here, on a copy of the analyzer's stats
+        auto stats = analyzer.stats();
+        auto* timed_stats = timing ? &stats : nullptr;
+        using catchy::analysis::Phase;
+        using catchy::analysis::PhaseTimer;
 
         // Display results using Tabulate
-        display_results(results);
+        if (!aggregate_only) {
+            PhaseTimer rendering(timed_stats, Phase::Rendering);
+            ResultTotals totals;
+            for_each_batch([&](const catchy::analysis::ResultStore& batch) { display_results(batch, totals); });
+            display_summary(totals);
+            if (explain) {
+                std::cout << "\nExplanation:\n";
+                for_each_batch(display_explanations);
+            }
+        }
+        // An incomplete snapshot would show every unanalyzed function as removed
+        if (!snapshot.empty() && !cancelled) {
+            // Keys relative to the input, so old/ and new/ checkouts match
+            std::string root = std::filesystem::is_directory(input_path) ? input_path.string()
+                                                                         : input_path.parent_path().string();
+            if (spill && spill->runs() > 0) {
+                catchy::analysis::SnapshotWriter writer(snapshot, false, root);
+                for_each_batch([&](const catchy::analysis::ResultStore& batch) {
+                    for (auto row : batch) {
+                        writer.write(row);
+                    }
+                });
+                writer.close();
+            } else {
+                catchy::analysis::write_snapshot(snapshot, results, root);
+            }
+        }
+        if (rollup || aggregate_only) {
+            PhaseTimer rendering(timed_stats, Phase::Rendering);
+            display_rollup(analyzer.rollup(), depth);
+        }
+        stats.run_wall_nanos = catchy::analysis::wall_clock_nanos() - run_wall_start;
+        stats.run_cpu_nanos = catchy::analysis::process_cpu_nanos() - run_cpu_start;
+        if (Stats) {
+            display_stats(stats);
+        }
+        if (!StatsJson.empty()) {
+            write_stats_json(stats, StatsJson);
+        }
+        if (cancelled) {
+            return 130;
+        }
     } catch (const std::exception& e) {
         spdlog::error("An error occurred: {}", e.what());
         return 1;
@@ -0,0 +1,35 @@
+#ifndef CATCHY_PARSER_FAST_SCANNER_HPP
+#define CATCHY_PARSER_FAST_SCANNER_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace catchy::parser {
+
+// Function found by a FastScanner, with its estimated complexity
+struct EstimatedFunction {
+    std::string name;
+    size_t start_line;
+    size_t end_line;
+    size_t complexity;
+};
+
+// Hand-written lexer for --mode=fast: finds functions and estimates their
+// cognitive complexity from keywords and brace or indentation nesting,
+// without building a parse tree. Names and lines follow the tree-sitter
+// parser of the same language so results can be compared. Scanners are
+// stateless and safe to share between threads.
+class FastScanner {
+public:
+    virtual ~FastScanner() = default;
+    virtual std::vector<EstimatedFunction> scan(std::string_view source) const = 0;
+};
+
+} // namespace catchy::parser
+
+#endif // CATCHY_PARSER_FAST_SCANNER_HPP
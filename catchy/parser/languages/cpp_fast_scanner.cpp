@@ -0,0 +1,562 @@
+#include "cpp_fast_scanner.hpp"
+#include <cstdint>
+
+namespace catchy::parser::languages {
+
+namespace {
+
+struct Token {
+    enum class Kind : uint8_t { Word, Punct, Literal };
+    Kind kind;
+    std::string_view text;
+    uint32_t line;
+};
+
+inline bool is_word_start(unsigned char c) {
+    return c == '_' || static_cast<unsigned>((c | 0x20) - 'a') < 26 || c >= 0x80;
+}
+
+inline bool is_word_char(unsigned char c) {
+    return is_word_start(c) || static_cast<unsigned>(c - '0') < 10;
+}
+
+class Tokenizer {
+public:
+    explicit Tokenizer(std::string_view source) : source_(source) {}
+
+    std::vector<Token> tokenize() {
+        std::vector<Token> tokens;
+        tokens.reserve(source_.size() / 4);
+        bool line_start = true;
+        while (pos_ < source_.size()) {
+            auto c = static_cast<unsigned char>(source_[pos_]);
+            if (c == '\n') {
+                ++line_;
+                ++pos_;
+                line_start = true;
+                continue;
+            }
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+                ++pos_;
+                continue;
+            }
+            if (c == '#' && line_start) {
+                skip_directive();
+                continue;
+            }
+            if (c == '/' && peek(1) == '/') {
+                skip_line();
+                continue;
+            }
+            if (c == '/' && peek(1) == '*') {
+                skip_block_comment();
+                continue;
+            }
+            line_start = false;
+
+            size_t start = pos_;
+            auto line = line_;
+            Token::Kind kind = Token::Kind::Punct;
+            if (is_word_start(c)) {
+                while (pos_ < source_.size() && is_word_char(static_cast<unsigned char>(source_[pos_]))) {
+                    ++pos_;
+                }
+                std::string_view word = source_.substr(start, pos_ - start);
+                char next = peek(0);
+                if (next == '"' && (word == "R" || word == "LR" || word == "uR" || word == "UR" || word == "u8R")) {
+                    skip_raw_string();
+                    kind = Token::Kind::Literal;
+                } else if ((next == '"' || next == '\'') &&
+                           (word == "L" || word == "u" || word == "U" || word == "u8")) {
+                    skip_quoted(next);
+                    kind = Token::Kind::Literal;
+                } else {
+                    kind = Token::Kind::Word;
+                }
+            } else if (static_cast<unsigned>(c - '0') < 10 || (c == '.' && static_cast<unsigned>(static_cast<unsigned char>(peek(1)) - '0') < 10)) {
+                skip_number();
+                kind = Token::Kind::Literal;
+            } else if (c == '"' || c == '\'') {
+                skip_quoted(static_cast<char>(c));
+                kind = Token::Kind::Literal;
+            } else {
+                ++pos_;
+            }
+            tokens.push_back({kind, source_.substr(start, pos_ - start), line});
+        }
+        return tokens;
+    }
+
+private:
+    char peek(size_t offset) const {
+        return pos_ + offset < source_.size() ? source_[pos_ + offset] : '\0';
+    }
+
+    void skip_line() {
+        while (pos_ < source_.size() && source_[pos_] != '\n') {
+            ++pos_;
+        }
+    }
+
+    // Directives, with their backslash continuations
+    void skip_directive() {
+        while (pos_ < source_.size() && source_[pos_] != '\n') {
+            if (source_[pos_] == '\\' && peek(1) == '\n') {
+                ++line_;
+                ++pos_;
+            } else if (source_[pos_] == '/' && peek(1) == '*') {
+                skip_block_comment();
+                continue;
+            }
+            ++pos_;
+        }
+    }
+
+    void skip_block_comment() {
+        pos_ += 2;
+        while (pos_ < source_.size() && !(source_[pos_] == '*' && peek(1) == '/')) {
+            line_ += source_[pos_] == '\n';
+            ++pos_;
+        }
+        pos_ = std::min(source_.size(), pos_ + 2);
+    }
+
+    // String or character literal; unterminated ones end at the line
+    void skip_quoted(char quote) {
+        ++pos_;
+        while (pos_ < source_.size() && source_[pos_] != quote && source_[pos_] != '\n') {
+            if (source_[pos_] == '\\' && pos_ + 1 < source_.size()) {
+                line_ += source_[pos_ + 1] == '\n';
+                ++pos_;
+            }
+            ++pos_;
+        }
+        if (pos_ < source_.size() && source_[pos_] == quote) {
+            ++pos_;
+        }
+    }
+
+    void skip_raw_string() {
+        size_t open = source_.find('(', pos_ + 1);
+        if (open == std::string_view::npos || open - pos_ > 17) {
+            skip_quoted('"');
+            return;
+        }
+        std::string terminator = ")";
+        terminator.append(source_.substr(pos_ + 1, open - pos_ - 1));
+        terminator += '"';
+        size_t close = source_.find(terminator, open + 1);
+        size_t end = close == std::string_view::npos ? source_.size() : close + terminator.size();
+        for (size_t i = pos_; i < end; ++i) {
+            line_ += source_[i] == '\n';
+        }
+        pos_ = end;
+    }
+
+    // Digit separators and exponent signs included
+    void skip_number() {
+        while (pos_ < source_.size()) {
+            char c = source_[pos_];
+            if (is_word_char(static_cast<unsigned char>(c)) || c == '.') {
+                ++pos_;
+            } else if (c == '\'' && is_word_char(static_cast<unsigned char>(peek(1)))) {
+                ++pos_;
+            } else if ((c == '+' || c == '-') && pos_ > 0 &&
+                       ((source_[pos_ - 1] | 0x20) == 'e' || (source_[pos_ - 1] | 0x20) == 'p')) {
+                ++pos_;
+            } else {
+                break;
+            }
+        }
+    }
+
+    std::string_view source_;
+    size_t pos_ {0};
+    uint32_t line_ {1};
+};
+
+class Scanner {
+public:
+    Scanner(const std::vector<Token>& tokens, std::vector<EstimatedFunction>& functions)
+        : tokens_(tokens), functions_(functions) {}
+
+    void run() {
+        for (size_t i = 0; i < tokens_.size(); i = scan_scope(i) + 1) {
+        }
+    }
+
+private:
+    enum class Block { Scope, Function, Skip };
+
+    enum class Construct : uint8_t { If, Else, Loop, Do, Catch, Try, Other };
+    enum class Phase : uint8_t { Header, BodyPending, Body };
+
+    // Open braces and control structures of a function body
+    struct Entry {
+        bool is_brace;
+        bool owned;     // Brace: the body of the construct below it
+        bool nesting;   // Construct: adds to the nesting level
+        Construct construct;
+        Phase phase;
+        int parens;     // Brace: parens open outside it; construct: depth of its header
+    };
+
+    bool is_punct(size_t i, char c) const {
+        return i < tokens_.size() && tokens_[i].kind == Token::Kind::Punct && tokens_[i].text[0] == c;
+    }
+
+    bool is_word(size_t i, std::string_view word) const {
+        return i < tokens_.size() && tokens_[i].kind == Token::Kind::Word && tokens_[i].text == word;
+    }
+
+    bool is_word(size_t i) const {
+        return i < tokens_.size() && tokens_[i].kind == Token::Kind::Word;
+    }
+
+    // Index of the '}' matching the '{' at `open`
+    size_t skip_balanced(size_t open) const {
+        int depth = 0;
+        for (size_t i = open; i < tokens_.size(); ++i) {
+            if (is_punct(i, '{')) {
+                ++depth;
+            } else if (is_punct(i, '}') && --depth == 0) {
+                return i;
+            }
+        }
+        return tokens_.size();
+    }
+
+    // Declarations of a namespace or class body, up to its closing brace
+    size_t scan_scope(size_t i) {
+        size_t begin = i;
+        int parens = 0;
+        bool seen_parameters = false;
+        bool init_list = false;
+        for (; i < tokens_.size(); ++i) {
+            const auto& token = tokens_[i];
+            if (token.kind == Token::Kind::Word) {
+                if (parens == 0 && is_punct(i + 1, ':') && !is_punct(i + 2, ':') &&
+                    (token.text == "public" || token.text == "private" || token.text == "protected")) {
+                    begin = i + 2;
+                    ++i;
+                }
+                continue;
+            }
+            if (token.kind != Token::Kind::Punct) {
+                continue;
+            }
+            switch (token.text[0]) {
+                case '(':
+                    ++parens;
+                    break;
+                case ')':
+                    parens = parens > 0 ? parens - 1 : 0;
+                    seen_parameters = seen_parameters || parens == 0;
+                    break;
+                case ';':
+                    if (parens == 0) {
+                        begin = i + 1;
+                        seen_parameters = init_list = false;
+                    }
+                    break;
+                case ':':
+                    if (parens == 0 && seen_parameters && !is_punct(i + 1, ':') && !is_punct(i - 1, ':')) {
+                        init_list = true;
+                    }
+                    break;
+                case '}':
+                    return i;
+                case '{': {
+                    if (parens > 0) {
+                        i = skip_balanced(i);
+                        break;
+                    }
+                    switch (classify(begin, i, init_list)) {
+                        case Block::Scope:
+                            i = scan_scope(i + 1);
+                            begin = i + 1;
+                            seen_parameters = init_list = false;
+                            break;
+                        case Block::Function:
+                            i = scan_function(begin, i);
+                            begin = i + 1;
+                            seen_parameters = init_list = false;
+                            break;
+                        case Block::Skip:
+                            i = skip_balanced(i);
+                            break;
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        return tokens_.size();
+    }
+
+    // First token of a declaration, past any template parameter lists
+    size_t declaration_start(size_t begin, size_t end) const {
+        while (is_word(begin, "template") && is_punct(begin + 1, '<')) {
+            int depth = 0;
+            size_t i = begin + 1;
+            for (; i < end; ++i) {
+                if (is_punct(i, '<')) {
+                    ++depth;
+                } else if (is_punct(i, '>') && --depth == 0) {
+                    break;
+                }
+            }
+            begin = i + 1;
+        }
+        return begin;
+    }
+
+    // The parameter list: the first top-level '(' following a name
+    size_t parameters_start(size_t begin, size_t end) const {
+        int depth = 0;
+        for (size_t i = begin; i < end; ++i) {
+            if (is_punct(i, '(')) {
+                if (depth++ == 0 && i > begin && is_word(i - 1)) {
+                    auto word = tokens_[i - 1].text;
+                    if (word != "decltype" && word != "noexcept" && word != "alignas" && word != "throw" &&
+                        word != "__attribute__" && word != "__declspec" && word != "requires") {
+                        return i;
+                    }
+                }
+            } else if (is_punct(i, ')')) {
+                --depth;
+            }
+        }
+        return end;
+    }
+
+    Block classify(size_t begin, size_t open, bool init_list) const {
+        begin = declaration_start(begin, open);
+        bool is_class = false;
+        bool assigns = false;
+        int depth = 0;
+        for (size_t i = begin; i < open; ++i) {
+            const auto& token = tokens_[i];
+            if (token.kind == Token::Kind::Punct) {
+                char c = token.text[0];
+                depth += c == '(' ? 1 : c == ')' ? -1 : 0;
+                if (c == '=' && depth == 0 && !is_word(i - 1, "operator")) {
+                    assigns = true;
+                }
+                continue;
+            }
+            if (token.kind != Token::Kind::Word || depth > 0) {
+                continue;
+            }
+            if (token.text == "namespace") {
+                return Block::Scope;
+            }
+            if (token.text == "extern" && i + 1 < open && tokens_[i + 1].kind == Token::Kind::Literal) {
+                return Block::Scope;
+            }
+            if (token.text == "enum") {
+                return Block::Skip;
+            }
+            is_class = is_class || token.text == "class" || token.text == "struct" || token.text == "union";
+        }
+
+        // Braced member initializers: ": a_{x}, b_{y} {"
+        if (init_list && (is_word(open - 1) || is_punct(open - 1, '>'))) {
+            return Block::Skip;
+        }
+        size_t parameters = parameters_start(begin, open);
+        if (parameters < open && !assigns) {
+            return Block::Function;
+        }
+        if (is_class && !assigns) {
+            return Block::Scope;
+        }
+        return Block::Skip;
+    }
+
+    // Name as the tree-sitter C++ parser reports it: the identifier, or for
+    // "a::b::c" everything after the outermost scope
+    std::string function_name(size_t begin, size_t open) const {
+        begin = declaration_start(begin, open);
+        size_t parameters = parameters_start(begin, open);
+        if (parameters >= open) {
+            return "";
+        }
+        for (size_t i = begin; i < parameters; ++i) {
+            if (is_word(i, "operator")) {
+                return "";
+            }
+        }
+        size_t first = parameters - 1;
+        while (first >= begin + 3 && is_punct(first - 1, ':') && is_punct(first - 2, ':') && is_word(first - 3)) {
+            first -= 3;
+        }
+        if (first + 1 < parameters) {
+            first += 3;
+        }
+        std::string name;
+        for (size_t i = first; i < parameters; ++i) {
+            name += tokens_[i].text;
+        }
+        return name;
+    }
+
+    size_t scan_function(size_t begin, size_t open) {
+        size_t complexity = 0;
+        size_t close = score_body(open, complexity);
+        std::string name = function_name(begin, open);
+        if (!name.empty()) {
+            size_t last = std::min(close, tokens_.size() - 1);
+            functions_.push_back({std::move(name), tokens_[declaration_start(begin, open)].line,
+                                  tokens_[last].line, complexity});
+        }
+        return close;
+    }
+
+    void push_construct(Construct construct, bool nesting, Phase phase, int parens) {
+        stack_.push_back({false, false, nesting, construct, phase, parens});
+        level_ += nesting ? 1 : 0;
+    }
+
+    void pop() {
+        if (!stack_.back().is_brace && stack_.back().nesting) {
+            --level_;
+        }
+        stack_.pop_back();
+    }
+
+    // The statement ending at `i` is complete, and with it every braceless
+    // control structure it was the body of. Returns the tokens consumed.
+    size_t complete_statement(size_t i) {
+        while (!stack_.empty() && !stack_.back().is_brace && stack_.back().phase == Phase::Body) {
+            Construct construct = stack_.back().construct;
+            pop();
+            if (construct == Construct::If && is_word(i + 1, "else")) {
+                push_construct(Construct::Else, true, Phase::BodyPending, 0);
+                return 1;
+            }
+            if (construct == Construct::Do && is_word(i + 1, "while")) {
+                do_while_ = true;
+                return 0;
+            }
+            if ((construct == Construct::Try || construct == Construct::Catch) && is_word(i + 1, "catch")) {
+                return 0;
+            }
+        }
+        return 0;
+    }
+
+    // Emulates CognitiveComplexity: +1 per control structure plus its
+    // nesting level for if/loops/catch, +1 per case label
+    size_t score_body(size_t open, size_t& complexity) {
+        stack_.clear();
+        level_ = 0;
+        do_while_ = false;
+        stack_.push_back({true, false, false, Construct::Other, Phase::Body, 0});
+        int parens = 0;
+
+        for (size_t i = open + 1; i < tokens_.size(); ++i) {
+            const auto& token = tokens_[i];
+            auto& top = stack_.back();
+            if (!top.is_brace && top.phase == Phase::BodyPending && !is_punct(i, '{')) {
+                top.phase = Phase::Body;
+            }
+
+            if (token.kind == Token::Kind::Punct) {
+                switch (token.text[0]) {
+                    case '(':
+                        ++parens;
+                        break;
+                    case ')':
+                        --parens;
+                        if (!top.is_brace && top.phase == Phase::Header && parens == top.parens) {
+                            top.phase = Phase::BodyPending;
+                        }
+                        break;
+                    case '{': {
+                        bool owned = !top.is_brace && top.phase == Phase::BodyPending;
+                        if (owned) {
+                            top.phase = Phase::Body;
+                        }
+                        stack_.push_back({true, owned, false, Construct::Other, Phase::Body, parens});
+                        parens = 0;
+                        break;
+                    }
+                    case '}': {
+                        while (!stack_.back().is_brace) {
+                            pop();
+                        }
+                        Entry brace = stack_.back();
+                        stack_.pop_back();
+                        if (stack_.empty()) {
+                            return i;
+                        }
+                        parens = brace.parens;
+                        if (brace.owned) {
+                            i += complete_statement(i);
+                        } else if (parens == 0 && !is_punct(i + 1, ';') && !is_punct(i + 1, ',') &&
+                                   !is_punct(i + 1, ')') && !is_word(i + 1, "catch")) {
+                            i += complete_statement(i);
+                        }
+                        break;
+                    }
+                    case ';':
+                        if (parens == 0) {
+                            i += complete_statement(i);
+                        }
+                        break;
+                    default:
+                        break;
+                }
+                continue;
+            }
+            if (token.kind != Token::Kind::Word) {
+                continue;
+            }
+
+            auto word = token.text;
+            if (word == "if") {
+                complexity += 1 + level_;
+                push_construct(Construct::If, true, Phase::Header, parens);
+            } else if (word == "for" || (word == "while" && !do_while_)) {
+                complexity += 1 + level_;
+                push_construct(Construct::Loop, true, Phase::Header, parens);
+            } else if (word == "while") {
+                do_while_ = false;
+            } else if (word == "do") {
+                complexity += 1 + level_;
+                push_construct(Construct::Do, true, Phase::BodyPending, parens);
+            } else if (word == "catch") {
+                complexity += 1 + level_;
+                push_construct(Construct::Catch, true, Phase::Header, parens);
+            } else if (word == "else") {
+                push_construct(Construct::Else, true, Phase::BodyPending, parens);
+            } else if (word == "switch") {
+                push_construct(Construct::Other, false, Phase::Header, parens);
+            } else if (word == "try") {
+                push_construct(Construct::Try, false, Phase::BodyPending, parens);
+            } else if (word == "case" || (word == "default" && is_punct(i + 1, ':'))) {
+                complexity += 1;
+            }
+        }
+        return tokens_.size();
+    }
+
+    const std::vector<Token>& tokens_;
+    std::vector<EstimatedFunction>& functions_;
+    std::vector<Entry> stack_;
+    size_t level_ {0};
+    bool do_while_ {false};
+};
+
+} // namespace
+
+std::vector<EstimatedFunction> CppFastScanner::scan(std::string_view source) const {
+    std::vector<EstimatedFunction> functions;
+    auto tokens = Tokenizer(source).tokenize();
+    Scanner(tokens, functions).run();
+    return functions;
+}
+
+} // namespace catchy::parser::languages
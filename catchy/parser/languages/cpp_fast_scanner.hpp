@@ -0,0 +1,20 @@
+#ifndef CATCHY_PARSER_CPP_FAST_SCANNER_HPP
+#define CATCHY_PARSER_CPP_FAST_SCANNER_HPP
+
+#pragma once
+
+#include "parser/fast_scanner.hpp"
+
+namespace catchy::parser::languages {
+
+// Tokenizes C++ (skipping comments, literals and preprocessor lines), finds
+// function bodies at namespace and class scope and scores them with a stack
+// of open control structures, braced or not
+class CppFastScanner : public FastScanner {
+public:
+    std::vector<EstimatedFunction> scan(std::string_view source) const override;
+};
+
+} // namespace catchy::parser::languages
+
+#endif // CATCHY_PARSER_CPP_FAST_SCANNER_HPP
@@ -1,7 +1,8 @@
 #include "cpp_parser.hpp"
+#include "cpp_fast_scanner.hpp"
+#include "utils/arena.hpp"
 #include "utils/safe_conversions.hpp"
 #include <spdlog/spdlog.h>
-#include <stack>
 #include <unordered_set>
 
 namespace catchy::parser::languages {
@@ -10,6 +11,10 @@ std::unique_ptr<ParserBase> CppParser::clone() const {
     return std::make_unique<CppParser>();
 }
 
+std::unique_ptr<FastScanner> CppParser::create_fast_scanner() const {
+    return std::make_unique<CppFastScanner>();
+}
+
 bool CppParser::initialize() {
     if (!parser_) {
         spdlog::error("Parser not initialized");
@@ -44,9 +49,7 @@ std::vector<FunctionInfo> CppParser::parse_functions(const ParserContext& contex
             return functions;
         }
 
-        TSNode root_node = ts_tree_root_node(tree);
-        collect_functions(root_node, context.file_content, functions, "");
-        
+        functions = find_functions(ts_tree_root_node(tree), context.file_content);
         ts_tree_delete(tree);
     } catch (const std::exception& e) {
         spdlog::error("Error parsing functions in {}: {}", context.file_path, e.what());
@@ -55,6 +58,12 @@ std::vector<FunctionInfo> CppParser::parse_functions(const ParserContext& contex
     return functions;
 }
 
+std::vector<FunctionInfo> CppParser::find_functions(TSNode root, const std::string& source) {
+    std::vector<FunctionInfo> functions;
+    collect_functions(root, source, functions, "");
+    return functions;
+}
+
 void CppParser::collect_functions(TSNode node, const std::string& source, 
                                 std::vector<FunctionInfo>& functions,
                                 const std::string& class_scope) {
@@ -76,19 +85,18 @@ void CppParser::collect_functions(TSNode node, const std::string& source,
             if (!ts_node_is_null(declarator)) {
                 TSNode name_node = find_function_name(declarator);
                 if (!ts_node_is_null(name_node)) {
-                    info.name = extract_node_text(name_node, source);
-                    if (!class_scope.empty()) {
-                        info.name = class_scope + "::" + info.name;
+                    if (extract_names_) {
+                        info.name = extract_node_text(name_node, source);
+                        if (!class_scope.empty()) {
+                            info.name = class_scope + "::" + info.name;
+                        }
                     }
                     
                     // Add debug logging
                     spdlog::debug("Found C++ function: {} at node type {}", info.name, type);
                     
-                    // Get function body
-                    TSNode body = ts_node_child_by_field_name(node, "body", strlen("body"));
-                    if (!ts_node_is_null(body)) {
-                        info.body = extract_node_text(body, source);
-                    }
+                    info.range = byte_range(node);
+                    info.body = byte_range(ts_node_child_by_field_name(node, "body", strlen("body")));
                     
                     // Get line numbers
                     TSPoint start = ts_node_start_point(node);
@@ -119,12 +127,12 @@ TSNode CppParser::find_function_name(TSNode declarator) {
         return TSNode{};
     }
 
-    std::stack<TSNode> nodes;
-    nodes.push(declarator);
+    std::pmr::vector<TSNode> nodes(utils::scratch_resource());
+    nodes.push_back(declarator);
     
     while (!nodes.empty()) {
-        TSNode current = nodes.top();
-        nodes.pop();
+        TSNode current = nodes.back();
+        nodes.pop_back();
         
         const char* type = ts_node_type(current);
         spdlog::debug("Finding function name in node type: {}", type);
@@ -158,7 +166,7 @@ TSNode CppParser::find_function_name(TSNode declarator) {
         // Add all children to stack
         uint32_t child_count = ts_node_child_count(current);
         for (uint32_t i = child_count; i > 0; --i) {
-            nodes.push(ts_node_child(current, i - 1));
+            nodes.push_back(ts_node_child(current, i - 1));
         }
     }
     
@@ -167,12 +175,12 @@ TSNode CppParser::find_function_name(TSNode declarator) {
 
 void CppParser::collect_parameters(TSNode declarator, const std::string& source, std::vector<std::string>& parameters) {
     // Find the parameter list node
-    std::stack<TSNode> nodes;
-    nodes.push(declarator);
+    std::pmr::vector<TSNode> nodes(utils::scratch_resource());
+    nodes.push_back(declarator);
     
     while (!nodes.empty()) {
-        TSNode current = nodes.top();
-        nodes.pop();
+        TSNode current = nodes.back();
+        nodes.pop_back();
         
         const char* type = ts_node_type(current);
         
@@ -195,7 +203,7 @@ void CppParser::collect_parameters(TSNode declarator, const std::string& source,
         
         uint32_t child_count = ts_node_child_count(current);
         for (uint32_t i = 0; i < child_count; i++) {
-            nodes.push(ts_node_child(current, i));
+            nodes.push_back(ts_node_child(current, i));
         }
     }
 }
@@ -32,8 +32,10 @@ public:
     std::unique_ptr<ParserBase> clone() const override;
     bool initialize() override;
     std::vector<FunctionInfo> parse_functions(const ParserContext& context) override;
+    std::vector<FunctionInfo> find_functions(TSNode root, const std::string& source) override;
     std::vector<std::string> get_extensions() const override;
     std::string get_language_name() const override;
+    std::unique_ptr<FastScanner> create_fast_scanner() const override;
 
     TSNode find_function_name(TSNode declarator);
 
@@ -0,0 +1,271 @@
+#include "python_fast_scanner.hpp"
+#include <cstdint>
+#include <iterator>
+
+namespace catchy::parser::languages {
+
+namespace {
+
+inline bool is_word_start(unsigned char c) {
+    return c == '_' || static_cast<unsigned>((c | 0x20) - 'a') < 26 || c >= 0x80;
+}
+
+inline bool is_word_char(unsigned char c) {
+    return is_word_start(c) || static_cast<unsigned>(c - '0') < 10;
+}
+
+// First words of one logical line
+struct LogicalLine {
+    size_t indent;
+    size_t first_line;
+    size_t last_line;
+    // Leading words, e.g. "async", "def" and the function name
+    std::string_view words[3];
+};
+
+class LineReader {
+public:
+    explicit LineReader(std::string_view source) : source_(source) {}
+
+    // False at the end of the source
+    bool next(LogicalLine& line) {
+        while (pos_ < source_.size()) {
+            size_t indent = read_indent();
+            if (pos_ >= source_.size()) {
+                return false;
+            }
+            char c = source_[pos_];
+            if (c == '\n' || c == '#' || c == '\r') {
+                skip_to_line_end();
+                continue;
+            }
+
+            line = LogicalLine{indent, line_, line_, {}};
+            read_line(line);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    char peek(size_t offset) const {
+        return pos_ + offset < source_.size() ? source_[pos_ + offset] : '\0';
+    }
+
+    size_t read_indent() {
+        size_t indent = 0;
+        while (pos_ < source_.size()) {
+            char c = source_[pos_];
+            if (c == ' ') {
+                ++indent;
+            } else if (c == '\t') {
+                indent = (indent / 8 + 1) * 8;
+            } else if (c != '\f') {
+                break;
+            }
+            ++pos_;
+        }
+        return indent;
+    }
+
+    void skip_to_line_end() {
+        while (pos_ < source_.size() && source_[pos_] != '\n') {
+            ++pos_;
+        }
+        if (pos_ < source_.size()) {
+            ++pos_;
+            ++line_;
+        }
+    }
+
+    void skip_string(size_t quote_start) {
+        char quote = source_[quote_start];
+        bool triple = peek(quote_start - pos_ + 1) == quote && peek(quote_start - pos_ + 2) == quote;
+        pos_ = quote_start + (triple ? 3 : 1);
+        while (pos_ < source_.size()) {
+            char c = source_[pos_];
+            if (c == '\\') {
+                line_ += peek(1) == '\n';
+                pos_ += 2;
+                continue;
+            }
+            if (c == '\n') {
+                if (!triple) {
+                    return;
+                }
+                ++line_;
+            } else if (c == quote && (!triple || (peek(1) == quote && peek(2) == quote))) {
+                pos_ += triple ? 3 : 1;
+                return;
+            }
+            ++pos_;
+        }
+    }
+
+    // Consume the rest of the logical line, recording its leading words
+    void read_line(LogicalLine& line) {
+        int brackets = 0;
+        size_t words = 0;
+        while (pos_ < source_.size()) {
+            auto c = static_cast<unsigned char>(source_[pos_]);
+            if (c == '\n') {
+                line.last_line = line_;
+                ++line_;
+                ++pos_;
+                if (brackets == 0) {
+                    return;
+                }
+                continue;
+            }
+            if (c == '\\' && peek(1) == '\n') {
+                ++line_;
+                pos_ += 2;
+                continue;
+            }
+            if (c == '#') {
+                while (pos_ < source_.size() && source_[pos_] != '\n') {
+                    ++pos_;
+                }
+                continue;
+            }
+            if (c == '"' || c == '\'') {
+                skip_string(pos_);
+                ++words;
+                continue;
+            }
+            if (is_word_start(c)) {
+                size_t start = pos_;
+                while (pos_ < source_.size() && is_word_char(static_cast<unsigned char>(source_[pos_]))) {
+                    ++pos_;
+                }
+                // String prefixes such as r, b, f and rb
+                if (pos_ - start <= 2 && (peek(0) == '"' || peek(0) == '\'')) {
+                    skip_string(pos_);
+                    ++words;
+                    continue;
+                }
+                if (words < std::size(line.words)) {
+                    line.words[words] = source_.substr(start, pos_ - start);
+                }
+                ++words;
+                continue;
+            }
+            if (c == '(' || c == '[' || c == '{') {
+                ++brackets;
+            } else if ((c == ')' || c == ']' || c == '}') && brackets > 0) {
+                --brackets;
+            }
+            if (c != ' ' && c != '\t' && c != '\r') {
+                ++words;
+            }
+            ++pos_;
+        }
+        line.last_line = line_;
+    }
+
+    std::string_view source_;
+    size_t pos_ {0};
+    size_t line_ {1};
+};
+
+enum class BlockKind : uint8_t { Function, If, Loop, Try, Other };
+
+struct Block {
+    size_t indent;
+    BlockKind kind;
+    size_t function; // Index into the results for functions
+};
+
+bool adds_nesting(BlockKind kind) {
+    return kind == BlockKind::If || kind == BlockKind::Loop;
+}
+
+} // namespace
+
+// Emulates CognitiveComplexity on the tree-sitter Python grammar: if, for
+// and while score 1 plus their nesting; elif and else score 1. Nested
+// functions are scored on their own and named "outer.inner".
+std::vector<EstimatedFunction> PythonFastScanner::scan(std::string_view source) const {
+    std::vector<EstimatedFunction> functions;
+    std::vector<Block> blocks;
+    LineReader reader(source);
+    LogicalLine line;
+    size_t last_line = 0;
+
+    auto close = [&](const Block& block) {
+        if (block.kind == BlockKind::Function) {
+            functions[block.function].end_line = last_line;
+        }
+    };
+
+    while (reader.next(line)) {
+        // Blocks end at the first line indented no deeper than their header
+        BlockKind closed_here = BlockKind::Other;
+        while (!blocks.empty() && blocks.back().indent >= line.indent) {
+            if (blocks.back().indent == line.indent) {
+                closed_here = blocks.back().kind;
+            }
+            close(blocks.back());
+            blocks.pop_back();
+        }
+
+        // Innermost function and the nesting level within it
+        const Block* function = nullptr;
+        size_t level = 0;
+        for (auto it = blocks.rbegin(); it != blocks.rend() && !function; ++it) {
+            if (it->kind == BlockKind::Function) {
+                function = &*it;
+            } else if (adds_nesting(it->kind)) {
+                ++level;
+            }
+        }
+        auto score = [&](size_t increment) {
+            if (function) {
+                functions[function->function].complexity += increment;
+            }
+        };
+
+        // "async def" and "async for" score like their plain forms
+        size_t first = line.words[0] == "async" ? 1 : 0;
+        std::string_view keyword = line.words[first];
+
+        if (keyword == "def") {
+            std::string name;
+            for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+                if (it->kind == BlockKind::Function) {
+                    name = functions[it->function].name + ".";
+                    break;
+                }
+            }
+            name += line.words[first + 1];
+            blocks.push_back({line.indent, BlockKind::Function, functions.size()});
+            functions.push_back({std::move(name), line.first_line, line.last_line, 0});
+        } else if (keyword == "if") {
+            score(1 + level);
+            blocks.push_back({line.indent, BlockKind::If, 0});
+        } else if (keyword == "elif") {
+            score(1);
+            blocks.push_back({line.indent, BlockKind::If, 0});
+        } else if (keyword == "else") {
+            score(1);
+            bool nests = closed_here == BlockKind::If || closed_here == BlockKind::Loop;
+            blocks.push_back({line.indent, nests ? closed_here : BlockKind::Try, 0});
+        } else if (keyword == "for" || keyword == "while") {
+            score(1 + level);
+            blocks.push_back({line.indent, BlockKind::Loop, 0});
+        } else if (keyword == "try" || keyword == "except" || keyword == "finally") {
+            blocks.push_back({line.indent, BlockKind::Try, 0});
+        } else if (keyword == "class" || keyword == "with" || keyword == "match" || keyword == "case") {
+            blocks.push_back({line.indent, BlockKind::Other, 0});
+        }
+        last_line = line.last_line;
+    }
+
+    while (!blocks.empty()) {
+        close(blocks.back());
+        blocks.pop_back();
+    }
+    return functions;
+}
+
+} // namespace catchy::parser::languages
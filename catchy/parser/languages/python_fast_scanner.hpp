@@ -0,0 +1,19 @@
+#ifndef CATCHY_PARSER_PYTHON_FAST_SCANNER_HPP
+#define CATCHY_PARSER_PYTHON_FAST_SCANNER_HPP
+
+#pragma once
+
+#include "parser/fast_scanner.hpp"
+
+namespace catchy::parser::languages {
+
+// Splits Python into logical lines (skipping comments and strings) and
+// tracks blocks by indentation; only statements starting a line are scored
+class PythonFastScanner : public FastScanner {
+public:
+    std::vector<EstimatedFunction> scan(std::string_view source) const override;
+};
+
+} // namespace catchy::parser::languages
+
+#endif // CATCHY_PARSER_PYTHON_FAST_SCANNER_HPP
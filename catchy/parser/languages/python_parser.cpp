@@ -1,7 +1,8 @@
 #include "python_parser.hpp"
+#include "python_fast_scanner.hpp"
+#include "utils/arena.hpp"
 #include "utils/safe_conversions.hpp"
 #include <spdlog/spdlog.h>
-#include <stack>
 
 namespace catchy::parser::languages {
 
@@ -10,6 +11,10 @@ std::unique_ptr<ParserBase> PythonParser::clone() const {
     return std::make_unique<PythonParser>();
 }
 
+std::unique_ptr<FastScanner> PythonParser::create_fast_scanner() const {
+    return std::make_unique<PythonFastScanner>();
+}
+
 bool PythonParser::initialize() {
     if (!parser_) {
         spdlog::error("Parser not initialized");
@@ -31,7 +36,6 @@ std::vector<FunctionInfo> PythonParser::parse_functions(const ParserContext& con
 
     try {
         spdlog::debug("Parsing file: {}", context.file_path);
-        spdlog::debug("File content:\n{}", context.file_content);
         
         TSTree* tree = ts_parser_parse_string(
             parser_.get(),
@@ -45,15 +49,11 @@ std::vector<FunctionInfo> PythonParser::parse_functions(const ParserContext& con
             return functions;
         }
 
-        TSNode root_node = ts_tree_root_node(tree);
-        spdlog::debug("Root node type: {}", ts_node_type(root_node));
-        
-        collect_functions(root_node, context.file_content, functions);
+        functions = find_functions(ts_tree_root_node(tree), context.file_content);
         
         spdlog::debug("Found {} functions", functions.size());
         for (const auto& func : functions) {
             spdlog::debug("Function: {} (lines {}-{})", func.name, func.start_line, func.end_line);
-            spdlog::debug("Function body:\n{}", func.body);
         }
         
         ts_tree_delete(tree);
@@ -74,15 +74,15 @@ std::string PythonParser::get_language_name() const {
 }
 
 TSNode PythonParser::find_function_name(TSNode declarator) {
-    std::stack<TSNode> nodes;
-    nodes.push(declarator);
+    std::pmr::vector<TSNode> nodes(utils::scratch_resource());
+    nodes.push_back(declarator);
     
     spdlog::debug("Looking for function name in declarator of type: {}", 
                   ts_node_type(declarator));
     
     while (!nodes.empty()) {
-        TSNode current = nodes.top();
-        nodes.pop();
+        TSNode current = nodes.back();
+        nodes.pop_back();
         
         const char* type = ts_node_type(current);
         spdlog::debug("Checking node type: {}", type);
@@ -94,7 +94,7 @@ TSNode PythonParser::find_function_name(TSNode declarator) {
         
         uint32_t child_count = ts_node_child_count(current);
         for (uint32_t i = 0; i < child_count; i++) {
-            nodes.push(ts_node_child(current, i));
+            nodes.push_back(ts_node_child(current, i));
         }
     }
     
@@ -102,6 +102,13 @@ TSNode PythonParser::find_function_name(TSNode declarator) {
     return TSNode{};
 }
 
+std::vector<FunctionInfo> PythonParser::find_functions(TSNode root, const std::string& source) {
+    spdlog::debug("Root node type: {}", ts_node_type(root));
+    std::vector<FunctionInfo> functions;
+    collect_functions(root, source, functions);
+    return functions;
+}
+
 void PythonParser::collect_functions(TSNode node, const std::string& source, std::vector<FunctionInfo>& functions) {
     const char* type = ts_node_type(node);
     spdlog::debug("Processing Python node type: {}", type);
@@ -124,7 +131,7 @@ void PythonParser::collect_functions(TSNode node, const std::string& source, std
             
             // Get function name
             TSNode name_node = ts_node_child_by_field_name(func_node, "name", strlen("name"));
-            if (!ts_node_is_null(name_node)) {
+            if (!ts_node_is_null(name_node) && extract_names_) {
                 info.name = extract_node_text(name_node, source);
                 spdlog::debug("Found Python function: {}", info.name);
                 
@@ -144,11 +151,8 @@ void PythonParser::collect_functions(TSNode node, const std::string& source, std
                 }
             }
 
-            // Get function body
-            TSNode body = ts_node_child_by_field_name(func_node, "body", strlen("body"));
-            if (!ts_node_is_null(body)) {
-                info.body = extract_node_text(body, source);
-            }
+            info.range = byte_range(func_node);
+            info.body = byte_range(ts_node_child_by_field_name(func_node, "body", strlen("body")));
             
             // Get line numbers
             TSPoint start = ts_node_start_point(func_node);
@@ -158,7 +162,11 @@ void PythonParser::collect_functions(TSNode node, const std::string& source, std
             
             spdlog::debug("Adding Python function {} (lines {}-{})", 
                          info.name, info.start_line, info.end_line);
-            functions.push_back(std::move(info));
+            // Without names, unnamed functions are left out here instead of
+            // by the caller
+            if (extract_names_ || !ts_node_is_null(name_node)) {
+                functions.push_back(std::move(info));
+            }
         }
 
         // Process children
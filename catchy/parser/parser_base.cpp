@@ -14,6 +14,13 @@ std::string ParserBase::extract_node_text(const TSNode &node, const std::string
     return source_code.substr(start_byte, end_byte - start_byte);
 }
 
+ByteRange ParserBase::byte_range(const TSNode &node) {
+    if (ts_node_is_null(node)) {
+        return {};
+    }
+    return {ts_node_start_byte(node), ts_node_end_byte(node)};
+}
+
 std::optional<std::string> ParserBase::get_function_name(const TSNode &node) {
     if (ts_node_is_null(node)) {
         return std::nullopt;
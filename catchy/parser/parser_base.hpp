@@ -3,20 +3,34 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <vector>
 #include <optional>
+#include "parser/fast_scanner.hpp"
 #include <tree_sitter/api.h>
 #include <spdlog/spdlog.h>
 
 namespace catchy::parser {
 
+// Half-open byte range into a parsed source
+struct ByteRange {
+    uint32_t start {0};
+    uint32_t end {0};
+
+    // Only valid while the source lives
+    std::string_view view(std::string_view source) const { return source.substr(start, end - start); }
+};
+
 struct FunctionInfo {
     std::string name;
     size_t start_line;
     size_t end_line;
-    std::string body;
+    // Whole definition and body; empty body for declarations without one
+    ByteRange range;
+    ByteRange body;
     TSNode node;
     std::vector<std::string> parameters;
 };
@@ -40,16 +54,27 @@ public:
     virtual std::unique_ptr<ParserBase> clone() const = 0;
 
     virtual bool initialize() = 0;
+    // Parses on its own; the returned nodes die with its tree, only names,
+    // lines and byte ranges stay valid
     virtual std::vector<FunctionInfo> parse_functions(const ParserContext &context) = 0;
+    // Functions of a tree parsed elsewhere; their nodes live as long as the tree
+    virtual std::vector<FunctionInfo> find_functions(TSNode root, const std::string &source) = 0;
     virtual std::vector<std::string> get_extensions() const = 0;
     virtual std::string get_language_name() const = 0;
+    // Lexer for --mode=fast; null if the language has none
+    virtual std::unique_ptr<FastScanner> create_fast_scanner() const { return nullptr; }
+    // Leave FunctionInfo::name empty, saving its allocation, when only
+    // ranges and nodes are needed; unnamed functions are still left out
+    void set_extract_names(bool enabled) { extract_names_ = enabled; }
 
 protected:
     // Helper functions for tree-sitter operations
     std::string extract_node_text(const TSNode &node, const std::string &source_code);
+    static ByteRange byte_range(const TSNode &node);
     std::optional<std::string> get_function_name(const TSNode &node);
 
     std::unique_ptr<TSParser, void(*)(TSParser*)> parser_;
+    bool extract_names_ {true};
 };
 
 } // namespace catchy::parser
@@ -30,9 +30,23 @@ std::unique_ptr<ParserBase> ParserFactory::create_parser(const std::string &lang
     return nullptr;
 }
 
+std::unique_ptr<FastScanner> ParserFactory::create_fast_scanner(const std::string &language) const {
+    auto it = parsers_.find(language);
+    if (it != parsers_.end()) {
+        return it->second->create_fast_scanner();
+    }
+    return nullptr;
+}
+
 std::unique_ptr<ParserBase> ParserFactory::create_parser_for_file(const std::string& filename) {
+    auto language = language_for_file(filename);
+    if (language.empty()) return nullptr;
+    return create_parser(language);
+}
+
+std::string ParserFactory::language_for_file(const std::string& filename) const {
     std::string ext = std::filesystem::path(filename).extension().string();
-    if (ext.empty()) return nullptr;
+    if (ext.empty()) return "";
     
     // Remove the dot from extension
     if (ext[0] == '.') {
@@ -41,9 +55,9 @@ std::unique_ptr<ParserBase> ParserFactory::create_parser_for_file(const std::str
 
     auto it = extensions_.find(ext);
     if (it != extensions_.end()) {
-        return create_parser(it->second);
+        return it->second;
     }
-    return nullptr;
+    return "";
 }
 
 std::vector<std::string> ParserFactory::get_supported_languages() const {
@@ -31,9 +31,16 @@ public:
     // Get parser by language name
     std::unique_ptr<ParserBase> create_parser(const std::string &language);
 
+    // Fast scanner of a registered language, null if it has none
+    std::unique_ptr<FastScanner> create_fast_scanner(const std::string &language) const;
+
     // Get parser by file extension
     std::unique_ptr<ParserBase> create_parser_for_file(const std::string &file_path);
 
+    // Language registered for a file's extension, empty if none; unlike
+    // create_parser_for_file this does not instantiate a parser
+    std::string language_for_file(const std::string &file_path) const;
+
     // Get supported languages
     std::vector<std::string> get_supported_languages() const;
 
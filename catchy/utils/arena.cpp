@@ -0,0 +1,190 @@
+#include "arena.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <tree_sitter/api.h>
+
+namespace catchy::utils {
+
+namespace {
+
+// Size header in front of every allocate_sized block, keeping malloc's alignment
+constexpr size_t header_size = alignof(std::max_align_t);
+
+thread_local Arena *current_arena = nullptr;
+thread_local size_t heap_allocations = 0;
+
+void *ts_arena_malloc(size_t size) {
+    if (current_arena) {
+        return current_arena->allocate_sized(size);
+    }
+    ++heap_allocations;
+    return std::malloc(size);
+}
+
+void *ts_arena_calloc(size_t count, size_t size) {
+    if (current_arena) {
+        void *ptr = current_arena->allocate_sized(count * size);
+        std::memset(ptr, 0, count * size);
+        return ptr;
+    }
+    ++heap_allocations;
+    return std::calloc(count, size);
+}
+
+void *ts_arena_realloc(void *ptr, size_t size) {
+    if (!ptr) {
+        return ts_arena_malloc(size);
+    }
+    if (current_arena && current_arena->owns(ptr)) {
+        return current_arena->reallocate_sized(ptr, size);
+    }
+    return std::realloc(ptr, size);
+}
+
+void ts_arena_free(void *ptr) {
+    if (current_arena && current_arena->owns(ptr)) {
+        return;
+    }
+    std::free(ptr);
+}
+
+} // namespace
+
+void Arena::reset() {
+    size_t kept = 0;
+    size_t retained = 0;
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        if (blocks_[i].size == block_size_ && retained + blocks_[i].size <= retained_bytes_) {
+            retained += blocks_[i].size;
+            if (kept != i) {
+                blocks_[kept] = std::move(blocks_[i]);
+            }
+            kept++;
+        }
+    }
+    blocks_.resize(kept);
+    index_blocks();
+    current_ = 0;
+    offset_ = 0;
+    last_ = nullptr;
+}
+
+bool Arena::owns(const void *ptr) const {
+    auto byte = static_cast<const std::byte *>(ptr);
+    if (current_ < blocks_.size()) {
+        const auto &block = blocks_[current_];
+        if (byte >= block.data.get() && byte < block.data.get() + block.size) {
+            return true;
+        }
+    }
+    // The last block starting at or before the pointer is the only candidate
+    auto it = std::upper_bound(ranges_.begin(), ranges_.end(), byte,
+                               [](const std::byte *value, const auto &range) { return value < range.first; });
+    return it != ranges_.begin() && byte < std::prev(it)->second;
+}
+
+void Arena::index_blocks() {
+    ranges_.clear();
+    for (const auto &block : blocks_) {
+        ranges_.emplace_back(block.data.get(), block.data.get() + block.size);
+    }
+    std::sort(ranges_.begin(), ranges_.end());
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (const auto &block : blocks_) {
+        total += block.size;
+    }
+    return total;
+}
+
+std::byte *Arena::bump(size_t bytes, size_t alignment) {
+    while (current_ < blocks_.size()) {
+        auto &block = blocks_[current_];
+        auto base = reinterpret_cast<uintptr_t>(block.data.get());
+        size_t aligned = ((base + offset_ + alignment - 1) & ~(alignment - 1)) - base;
+        if (aligned + bytes <= block.size) {
+            offset_ = aligned + bytes;
+            return block.data.get() + aligned;
+        }
+        ++current_;
+        offset_ = 0;
+    }
+
+    // Oversized requests get a block of their own
+    size_t size = std::max(block_size_, bytes + alignment);
+    blocks_.push_back({std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+    const std::byte *begin = blocks_.back().data.get();
+    ranges_.insert(std::upper_bound(ranges_.begin(), ranges_.end(), std::make_pair(begin, begin + size)),
+                   {begin, begin + size});
+    current_ = blocks_.size() - 1;
+    offset_ = 0;
+    return bump(bytes, alignment);
+}
+
+void *Arena::do_allocate(size_t bytes, size_t alignment) {
+    last_ = nullptr;
+    return bump(bytes, alignment);
+}
+
+void *Arena::allocate_sized(size_t size) {
+    std::byte *block = bump(header_size + size, alignof(std::max_align_t));
+    std::memcpy(block, &size, sizeof(size));
+    last_ = block;
+    return block + header_size;
+}
+
+void *Arena::reallocate_sized(void *ptr, size_t size) {
+    std::byte *block = static_cast<std::byte *>(ptr) - header_size;
+    size_t old_size;
+    std::memcpy(&old_size, block, sizeof(old_size));
+
+    if (block == last_) {
+        auto &current = blocks_[current_];
+        size_t start = static_cast<size_t>(block - current.data.get());
+        if (start + header_size + size <= current.size) {
+            offset_ = start + header_size + size;
+            std::memcpy(block, &size, sizeof(size));
+            return ptr;
+        }
+    }
+
+    void *moved = allocate_sized(size);
+    std::memcpy(moved, ptr, std::min(old_size, size));
+    return moved;
+}
+
+ArenaScope::ArenaScope(Arena &arena) : arena_(arena), previous_(current_arena) {
+    current_arena = &arena;
+}
+
+ArenaScope::~ArenaScope() {
+    current_arena = previous_;
+    arena_.reset();
+}
+
+std::pmr::memory_resource *scratch_resource() {
+    if (current_arena) {
+        return current_arena;
+    }
+    return std::pmr::new_delete_resource();
+}
+
+void install_tree_sitter_allocator() {
+    static const bool installed = [] {
+        ts_set_allocator(ts_arena_malloc, ts_arena_calloc, ts_arena_realloc, ts_arena_free);
+        return true;
+    }();
+    (void)installed;
+}
+
+size_t tree_sitter_heap_allocations() {
+    return heap_allocations;
+}
+
+} // namespace catchy::utils
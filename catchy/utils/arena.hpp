@@ -0,0 +1,93 @@
+#ifndef CATCHY_UTILS_ARENA_HPP
+#define CATCHY_UTILS_ARENA_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+namespace catchy::utils {
+
+// Bump allocator for the memory of one file's analysis. Allocations are
+// carved from large blocks and never freed on their own; reset() rewinds
+// every block in one step and keeps up to `retained_bytes` of them for the
+// next file. Not thread safe: each worker owns one.
+class Arena : public std::pmr::memory_resource {
+public:
+    explicit Arena(size_t block_size = 1 << 20, size_t retained_bytes = 4 << 20)
+        : block_size_(block_size), retained_bytes_(retained_bytes) {}
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    // Invalidates everything allocated since the last reset. Oversized
+    // blocks and those beyond the retained bytes go back to the heap, so one
+    // large file does not pin its footprint for the rest of the run.
+    void reset();
+    // Checks the current block, then binary searches the others; called on
+    // every tree-sitter free and realloc
+    bool owns(const void *ptr) const;
+    // Bytes held in blocks, used or not
+    size_t capacity() const;
+
+    // malloc-style allocation that remembers its size, for realloc
+    void *allocate_sized(size_t size);
+    // Grows in place when `ptr` is the latest allocation
+    void *reallocate_sized(void *ptr, size_t size);
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    std::byte *bump(size_t bytes, size_t alignment);
+    void index_blocks();
+
+    size_t block_size_;
+    size_t retained_bytes_;
+    std::vector<Block> blocks_;
+    // [begin, end) of every block, sorted by address for owns()
+    std::vector<std::pair<const std::byte *, const std::byte *>> ranges_;
+    size_t current_ {0};
+    size_t offset_ {0};
+    // Start of the latest allocate_sized block, which may grow in place
+    std::byte *last_ {nullptr};
+};
+
+// Makes `arena` the calling thread's arena for tree-sitter and scratch
+// allocations; the arena is reset when the scope ends. Everything
+// allocated inside must be destroyed before then.
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena &arena);
+    ~ArenaScope();
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+private:
+    Arena &arena_;
+    Arena *previous_;
+};
+
+// The calling thread's arena inside an ArenaScope, the heap outside
+std::pmr::memory_resource *scratch_resource();
+
+// Routes tree-sitter's allocations to the calling thread's arena while one
+// is in scope, and to malloc otherwise. Frees of pointers the arena does not
+// own go to free, so objects created before installing are unaffected.
+// Idempotent.
+void install_tree_sitter_allocator();
+
+// tree-sitter allocations the calling thread sent to malloc
+size_t tree_sitter_heap_allocations();
+
+} // namespace catchy::utils
+
+#endif // CATCHY_UTILS_ARENA_HPP
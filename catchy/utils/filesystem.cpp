@@ -1,8 +1,17 @@
 #include "filesystem.hpp"
+#include "ignore.hpp"
 #include <filesystem>
 #include <fstream>
 #include <sstream>
-#include <regex>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <dirent.h>
+#include <sys/stat.h>
 
 namespace catchy::utils {
 
@@ -19,37 +28,208 @@ std::string read_file_content(const std::string &file_path) {
     return buffer.str();
 }
 
-std::vector<std::string> list_files(const std::string& dir_path, bool recursive) {
+namespace {
+
+bool has_extension(std::string_view name, const std::vector<std::string>& extensions) {
+    if (extensions.empty()) {
+        return true;
+    }
+    auto dot = name.rfind('.');
+    if (dot == std::string_view::npos || dot == 0) {
+        return false;
+    }
+    auto extension = name.substr(dot + 1);
+    return std::find(extensions.begin(), extensions.end(), extension) != extensions.end();
+}
+
+bool is_pruned(std::string_view name, const WalkOptions& options) {
+    if (!options.prune_default_directories) {
+        return false;
+    }
+    const auto& pruned = default_pruned_directories();
+    return std::find(pruned.begin(), pruned.end(), name) != pruned.end();
+}
+
+struct PendingDirectory {
+    std::string path;
+    std::shared_ptr<const IgnoreScope> ignores;
+};
+
+// Shared queue of directories still to be scanned
+struct WalkState {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<PendingDirectory> pending;
+    size_t active {0};
     std::vector<std::string> files;
-    try {
-        if (recursive) {
-            for (const auto &entry : fs::recursive_directory_iterator(dir_path)) {
-                if (fs::is_regular_file(entry.path())) {
-                    files.push_back(entry.path().string());
-                }
+};
+
+struct DirectoryEntry {
+    std::string name;
+    unsigned char type;
+};
+
+void scan_directory(const PendingDirectory& directory, const WalkOptions& options,
+                    std::vector<std::string>& files, std::vector<PendingDirectory>& directories) {
+    DIR* dir = opendir(directory.path.c_str());
+    if (!dir) {
+        return;
+    }
+
+    std::string prefix = directory.path;
+    if (prefix.empty() || prefix.back() != '/') {
+        prefix += '/';
+    }
+
+    // Read every entry first: ignore files apply to their own siblings
+    std::vector<DirectoryEntry> entries;
+    bool has_ignore_file = false;
+    while (dirent* entry = readdir(dir)) {
+        std::string_view name(entry->d_name);
+        if (name == "." || name == "..") {
+            continue;
+        }
+        unsigned char type = DT_UNKNOWN;
+#ifdef _DIRENT_HAVE_D_TYPE
+        type = entry->d_type;
+#endif
+        if (options.respect_ignore_files) {
+            const auto& ignore_names = ignore_file_names();
+            has_ignore_file = has_ignore_file ||
+                std::find(ignore_names.begin(), ignore_names.end(), name) != ignore_names.end();
+        }
+        entries.push_back({std::string(name), type});
+    }
+    closedir(dir);
+
+    auto ignores = directory.ignores;
+    if (has_ignore_file) {
+        IgnoreFile rules;
+        for (const auto& name : ignore_file_names()) {
+            rules.load(prefix + name);
+        }
+        if (!rules.empty()) {
+            ignores = std::make_shared<IgnoreScope>(ignores, std::move(rules), prefix);
+        }
+    }
+
+    std::string path;
+    for (const auto& entry : entries) {
+        const std::string& name = entry.name;
+        path.assign(prefix).append(name);
+
+        // Symlinks are followed to files but never to directories
+        unsigned char type = entry.type;
+        bool is_link = type == DT_LNK;
+        if (type == DT_UNKNOWN || type == DT_LNK) {
+            if (type == DT_LNK && !has_extension(name, options.extensions)) {
+                continue;
             }
-        } else {
-            for (const auto &entry : fs::directory_iterator(dir_path)) {
-                if (fs::is_regular_file(entry.path())) {
-                    files.push_back(entry.path().string());
-                }
+            struct stat status {};
+            int rc = is_link ? stat(path.c_str(), &status) : lstat(path.c_str(), &status);
+            if (rc != 0) {
+                continue;
             }
+            type = S_ISREG(status.st_mode) ? DT_REG : S_ISDIR(status.st_mode) ? DT_DIR : DT_UNKNOWN;
         }
-    } catch (const fs::filesystem_error &e) {
-        throw std::runtime_error("Failed to list files in directory: " + dir_path);
+
+        if (type == DT_DIR && !is_link) {
+            if (!options.recursive || is_pruned(name, options) ||
+                (options.respect_ignore_files && name == ".git")) {
+                continue;
+            }
+            if ((ignores && ignores->is_ignored(path, name, true)) ||
+                (options.ignore_patterns && options.ignore_patterns->matches_entry(path, name)) ||
+                (options.skip_directory && options.skip_directory(path))) {
+                continue;
+            }
+            directories.push_back({path, ignores});
+        } else if (type == DT_REG && has_extension(name, options.extensions)) {
+            if ((ignores && ignores->is_ignored(path, name, false)) ||
+                (options.ignore_patterns && options.ignore_patterns->matches_entry(path, name))) {
+                continue;
+            }
+            files.push_back(path);
+        }
+    }
+}
+
+void walk_worker(WalkState& state, const WalkOptions& options) {
+    std::vector<std::string> files;
+    std::vector<PendingDirectory> directories;
+    while (true) {
+        PendingDirectory directory;
+        {
+            std::unique_lock lock(state.mutex);
+            state.changed.wait(lock, [&] { return !state.pending.empty() || state.active == 0; });
+            if (state.pending.empty()) {
+                return;
+            }
+            directory = std::move(state.pending.front());
+            state.pending.pop_front();
+            state.active++;
+        }
+
+        files.clear();
+        directories.clear();
+        scan_directory(directory, options, files, directories);
+
+        {
+            std::lock_guard lock(state.mutex);
+            for (auto& subdirectory : directories) {
+                state.pending.push_back(std::move(subdirectory));
+            }
+            for (auto& file : files) {
+                state.files.push_back(std::move(file));
+            }
+            state.active--;
+        }
+        state.changed.notify_all();
     }
+}
+
+} // namespace
 
-    return files;
+const std::vector<std::string>& default_pruned_directories() {
+    static const std::vector<std::string> directories = {
+        ".git", ".hg", ".svn",
+        "node_modules", "bower_components", "vendor", "third_party",
+        "__pycache__", ".venv", "venv", ".tox", ".mypy_cache", ".pytest_cache",
+        "build", "_build", "dist", "cmake-build-debug", "cmake-build-release",
+        ".cache", ".idea", ".vscode"
+    };
+    return directories;
 }
 
-bool matches_pattern(const std::string &text, const std::string &pattern) {
-    try {
-        std::regex regex(pattern);
-        return std::regex_match(text, regex);
-    } catch (const std::regex_error &e) {
-        // If pattern is invalid, treat it as a simple string match
-        return text.find(pattern) != std::string::npos;
+std::vector<std::string> walk_files(const std::string& directory_path, const WalkOptions& options) {
+    struct stat status {};
+    if (stat(directory_path.c_str(), &status) != 0 || !S_ISDIR(status.st_mode)) {
+        throw std::runtime_error("Failed to list files in directory: " + directory_path);
+    }
+
+    WalkState state;
+    std::string root = directory_path;
+    if (root.empty() || root.back() != '/') {
+        root += '/';
+    }
+    std::shared_ptr<const IgnoreScope> ignores;
+    if (options.respect_ignore_files) {
+        ignores = load_enclosing_ignores(root);
+    }
+    state.pending.push_back({directory_path, ignores});
+
+    size_t threads = options.recursive ? std::max<size_t>(1, options.threads) : 1;
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(walk_worker, std::ref(state), std::cref(options));
+    }
+    walk_worker(state, options);
+    for (auto& worker : workers) {
+        worker.join();
     }
+
+    std::sort(state.files.begin(), state.files.end());
+    return std::move(state.files);
 }
 
 std::string normalize_path(const std::string &path) {
@@ -3,20 +3,43 @@
 
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
 
 namespace catchy::utils {
 
+class IgnorePatterns;
+
 // File reading operations
 std::string read_file_content(const std::string &file_path);
 
 //  Directory operations
-std::vector<std::string> list_files(const std::string &directory_path, bool recursive = false);
-
+struct WalkOptions {
+    bool recursive {false};
+    // Accepted extensions without the leading dot; empty accepts every file
+    std::vector<std::string> extensions;
+    // Skip default_pruned_directories() without entering them
+    bool prune_default_directories {true};
+    // Honor .gitignore, .git/info/exclude and .catchyignore
+    bool respect_ignore_files {true};
+    // Additional patterns to skip, checked on every entry
+    const IgnorePatterns *ignore_patterns {nullptr};
+    // Directories (as walked) the caller wants pruned; called from any thread
+    std::function<bool(const std::string &)> skip_directory;
+    size_t threads {1};
+};
+
+// Vendored, generated and build directories that are never analyzed
+const std::vector<std::string> &default_pruned_directories();
+
+// Collect the regular files under a directory, filtering by extension and
+// pruning default and ignored directories before entering them. Entry types come from readdir where the
+// filesystem provides them, so most entries never need a stat call.
+// Subdirectories are walked in parallel; the result is sorted.
+std::vector<std::string> walk_files(const std::string &directory_path, const WalkOptions &options);
 
-// Pattern matching
-bool matches_pattern(const std::string &text, const std::string &pattern);
 
 // Path operations
 std::string normalize_path(const std::string &path);
@@ -0,0 +1,404 @@
+#include "glob.hpp"
+#include <algorithm>
+#include <map>
+#include <optional>
+
+namespace catchy::utils {
+
+namespace {
+
+using Token = Glob::Token;
+using Type = Glob::Token::Type;
+
+Token make_token(Type type, char c = 0) {
+    Token token;
+    token.type = type;
+    token.c = c;
+    return token;
+}
+
+// Parse a character class starting after '['; returns false if unterminated
+bool parse_class(std::string_view pattern, size_t& pos, Token& token) {
+    size_t i = pos;
+    if (i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^')) {
+        token.negated = true;
+        ++i;
+    }
+    bool first = true;
+    while (i < pattern.size() && (first || pattern[i] != ']')) {
+        first = false;
+        auto low = static_cast<unsigned char>(pattern[i]);
+        if (low == '\\' && i + 1 < pattern.size()) {
+            low = static_cast<unsigned char>(pattern[++i]);
+        }
+        auto high = low;
+        if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+            high = static_cast<unsigned char>(pattern[i + 2]);
+            i += 2;
+        }
+        token.ranges.emplace_back(low, high);
+        ++i;
+    }
+    if (i >= pattern.size()) {
+        return false;
+    }
+    pos = i + 1;
+    return true;
+}
+
+std::vector<Token> compile(std::string_view pattern) {
+    std::vector<Token> tokens;
+    size_t i = 0;
+    while (i < pattern.size()) {
+        char c = pattern[i];
+        if (c == '\\' && i + 1 < pattern.size()) {
+            tokens.push_back(make_token(Type::Literal, pattern[i + 1]));
+            i += 2;
+        } else if (c == '*') {
+            size_t end = i;
+            while (end < pattern.size() && pattern[end] == '*') {
+                ++end;
+            }
+            bool segment_start = i == 0 || pattern[i - 1] == '/';
+            if (end - i >= 2 && segment_start && end < pattern.size() && pattern[end] == '/') {
+                // "**/": zero or more directories
+                Token skip = make_token(Type::Skip);
+                skip.skip = 2;
+                tokens.push_back(skip);
+                tokens.push_back(make_token(Type::StarCross));
+                tokens.push_back(make_token(Type::Literal, '/'));
+                end++;
+            } else if (end - i >= 2 && segment_start && end == pattern.size()) {
+                // Trailing "**": everything, or everything inside the directory
+                if (i > 0) {
+                    tokens.push_back(make_token(Type::AnyByte));
+                }
+                tokens.push_back(make_token(Type::StarCross));
+            } else {
+                tokens.push_back(make_token(Type::Star));
+            }
+            i = end;
+        } else if (c == '?') {
+            tokens.push_back(make_token(Type::AnyChar));
+            ++i;
+        } else if (c == '[') {
+            Token token = make_token(Type::Class);
+            size_t pos = i + 1;
+            if (parse_class(pattern, pos, token)) {
+                tokens.push_back(std::move(token));
+                i = pos;
+            } else {
+                tokens.push_back(make_token(Type::Literal, c));
+                ++i;
+            }
+        } else {
+            tokens.push_back(make_token(Type::Literal, c));
+            ++i;
+        }
+    }
+    return tokens;
+}
+
+// State sets of the automaton: one bit per token position
+struct SmallSet {
+    uint64_t bits {0};
+    bool test(size_t i) const { return (bits >> i) & 1; }
+    void set(size_t i) { bits |= uint64_t{1} << i; }
+    void clear() { bits = 0; }
+    bool empty() const { return bits == 0; }
+};
+
+struct LargeSet {
+    std::vector<uint8_t> bits;
+    explicit LargeSet(size_t size) : bits(size, 0) {}
+    bool test(size_t i) const { return bits[i] != 0; }
+    void set(size_t i) { bits[i] = 1; }
+    void clear() { std::fill(bits.begin(), bits.end(), 0); }
+    bool empty() const { return std::find(bits.begin(), bits.end(), 1) == bits.end(); }
+};
+
+// Epsilon edges only point forward, so one pass computes the closure
+template <typename Set>
+void close(const std::vector<Token>& tokens, Set& states) {
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (!states.test(i)) {
+            continue;
+        }
+        const auto& token = tokens[i];
+        if (token.type == Type::Star || token.type == Type::StarCross) {
+            states.set(i + 1);
+        } else if (token.type == Type::Skip) {
+            states.set(i + 1);
+            states.set(std::min(tokens.size(), i + 1 + token.skip));
+        }
+    }
+}
+
+template <typename Set>
+bool simulate(const std::vector<Token>& tokens, std::string_view text, Set current, Set next) {
+    current.set(0);
+    close(tokens, current);
+    for (char c : text) {
+        auto byte = static_cast<unsigned char>(c);
+        next.clear();
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            if (!current.test(i)) {
+                continue;
+            }
+            const auto& token = tokens[i];
+            switch (token.type) {
+                case Type::Star:
+                    if (byte != '/') next.set(i);
+                    break;
+                case Type::StarCross:
+                    next.set(i);
+                    break;
+                case Type::Skip:
+                    break;
+                default:
+                    if (token.accepts(byte)) next.set(i + 1);
+                    break;
+            }
+        }
+        if (next.empty()) {
+            return false;
+        }
+        close(tokens, next);
+        std::swap(current, next);
+    }
+    return current.test(tokens.size());
+}
+
+} // namespace
+
+bool Glob::Token::accepts(unsigned char byte) const {
+    switch (type) {
+        case Type::Literal:
+            return byte == static_cast<unsigned char>(c);
+        case Type::AnyChar:
+            return byte != '/';
+        case Type::AnyByte:
+            return true;
+        case Type::Class: {
+            if (byte == '/') {
+                return false;
+            }
+            bool in_class = std::any_of(ranges.begin(), ranges.end(), [byte](const auto& range) {
+                return byte >= range.first && byte <= range.second;
+            });
+            return in_class != negated;
+        }
+        default:
+            return false;
+    }
+}
+
+Glob::Glob(std::string_view pattern) : pattern_(pattern), tokens_(compile(pattern)) {
+    auto is_plain = [](const Token& token) {
+        return token.type == Type::Literal;
+    };
+    if (std::all_of(tokens_.begin(), tokens_.end(), is_plain)) {
+        is_literal_ = true;
+    } else if (tokens_.front().type == Type::Star &&
+               std::all_of(tokens_.begin() + 1, tokens_.end(), [](const Token& token) {
+                   return token.type == Type::Literal && token.c != '/';
+               })) {
+        is_suffix_ = true;
+    } else {
+        return;
+    }
+    for (const auto& token : tokens_) {
+        if (token.type == Type::Literal) {
+            literal_ += token.c;
+        }
+    }
+}
+
+bool Glob::matches(std::string_view text) const {
+    if (is_literal_) {
+        return text == literal_;
+    }
+    if (is_suffix_) {
+        return text.size() >= literal_.size() &&
+               text.substr(text.size() - literal_.size()) == literal_ &&
+               text.substr(0, text.size() - literal_.size()).find('/') == std::string_view::npos;
+    }
+    if (tokens_.size() < 64) {
+        return simulate(tokens_, text, SmallSet{}, SmallSet{});
+    }
+    return simulate(tokens_, text, LargeSet(tokens_.size() + 1), LargeSet(tokens_.size() + 1));
+}
+
+void GlobSet::add(std::string_view pattern, int id) {
+    globs_.emplace_back(pattern);
+    ids_.push_back(id);
+    transitions_.clear();
+    accept_.clear();
+}
+
+void GlobSet::compile() {
+    transitions_.clear();
+    accept_.clear();
+    fallback_ = false;
+    start_ = 0;
+    if (globs_.empty()) {
+        return;
+    }
+
+    // Every glob's positions laid out one after another; each glob's last
+    // position is its accepting state
+    std::vector<size_t> offsets;
+    std::vector<uint32_t> owner;
+    size_t total = 0;
+    for (size_t g = 0; g < globs_.size(); ++g) {
+        offsets.push_back(total);
+        total += globs_[g].tokens().size() + 1;
+        owner.resize(total, static_cast<uint32_t>(g));
+    }
+
+    // Bytes that no token can tell apart share a class
+    std::vector<uint32_t> key(256, 0);
+    auto refine = [&](auto&& predicate) {
+        std::map<std::pair<uint32_t, bool>, uint32_t> renumber;
+        for (size_t b = 0; b < 256; ++b) {
+            auto [it, inserted] = renumber.try_emplace(
+                {key[b], predicate(static_cast<unsigned char>(b))},
+                static_cast<uint32_t>(renumber.size()));
+            key[b] = it->second;
+        }
+        class_count_ = renumber.size();
+    };
+    refine([](unsigned char b) { return b == '/'; });
+    for (const auto& glob : globs_) {
+        for (const auto& token : glob.tokens()) {
+            if (token.type == Type::Literal || token.type == Type::Class) {
+                refine([&token](unsigned char b) { return token.accepts(b); });
+            }
+        }
+    }
+    std::vector<unsigned char> representative(class_count_);
+    for (size_t b = 256; b-- > 0;) {
+        byte_class_[b] = static_cast<uint8_t>(key[b]);
+        representative[key[b]] = static_cast<unsigned char>(b);
+    }
+
+    auto close_set = [&](std::vector<char>& set) {
+        for (size_t s = 0; s < total; ++s) {
+            if (!set[s]) {
+                continue;
+            }
+            size_t g = owner[s];
+            size_t position = s - offsets[g];
+            const auto& tokens = globs_[g].tokens();
+            if (position == tokens.size()) {
+                continue;
+            }
+            const auto& token = tokens[position];
+            if (token.type == Type::Star || token.type == Type::StarCross) {
+                set[s + 1] = 1;
+            } else if (token.type == Type::Skip) {
+                set[s + 1] = 1;
+                set[offsets[g] + std::min(tokens.size(), position + 1 + token.skip)] = 1;
+            }
+        }
+    };
+
+    std::map<std::vector<uint32_t>, uint32_t> state_ids;
+    std::vector<std::vector<uint32_t>> states;
+    auto intern = [&](const std::vector<char>& set) -> std::optional<uint32_t> {
+        std::vector<uint32_t> members;
+        int accept = no_match;
+        for (size_t s = 0; s < total; ++s) {
+            if (set[s]) {
+                members.push_back(static_cast<uint32_t>(s));
+                size_t g = owner[s];
+                if (s - offsets[g] == globs_[g].tokens().size()) {
+                    accept = std::max(accept, ids_[g]);
+                }
+            }
+        }
+        auto it = state_ids.find(members);
+        if (it != state_ids.end()) {
+            return it->second;
+        }
+        if (states.size() >= max_states) {
+            return std::nullopt;
+        }
+        auto id = static_cast<uint32_t>(states.size());
+        state_ids.emplace(members, id);
+        states.push_back(std::move(members));
+        accept_.push_back(accept);
+        transitions_.resize(states.size() * class_count_, 0);
+        return id;
+    };
+
+    std::vector<char> set(total, 0);
+    intern(set); // Dead state
+    for (size_t g = 0; g < globs_.size(); ++g) {
+        set[offsets[g]] = 1;
+    }
+    close_set(set);
+    start_ = *intern(set);
+
+    for (size_t state = 1; state < states.size(); ++state) {
+        for (size_t c = 0; c < class_count_; ++c) {
+            unsigned char byte = representative[c];
+            std::fill(set.begin(), set.end(), 0);
+            for (uint32_t s : states[state]) {
+                size_t g = owner[s];
+                size_t position = s - offsets[g];
+                const auto& tokens = globs_[g].tokens();
+                if (position == tokens.size()) {
+                    continue;
+                }
+                const auto& token = tokens[position];
+                switch (token.type) {
+                    case Type::Star:
+                        if (byte != '/') set[s] = 1;
+                        break;
+                    case Type::StarCross:
+                        set[s] = 1;
+                        break;
+                    case Type::Skip:
+                        break;
+                    default:
+                        if (token.accepts(byte)) set[s + 1] = 1;
+                        break;
+                }
+            }
+            close_set(set);
+            auto next = intern(set);
+            if (!next) {
+                // Too many states; match glob by glob instead
+                fallback_ = true;
+                transitions_.clear();
+                accept_.clear();
+                return;
+            }
+            transitions_[state * class_count_ + c] = *next;
+        }
+    }
+}
+
+int GlobSet::best_match(std::string_view text) const {
+    if (fallback_ || transitions_.empty()) {
+        int best = no_match;
+        for (size_t i = 0; i < globs_.size(); ++i) {
+            if (ids_[i] > best && globs_[i].matches(text)) {
+                best = ids_[i];
+            }
+        }
+        return best;
+    }
+
+    uint32_t state = start_;
+    for (char c : text) {
+        state = transitions_[state * class_count_ + byte_class_[static_cast<unsigned char>(c)]];
+        if (state == 0) {
+            return no_match;
+        }
+    }
+    return accept_[state];
+}
+
+} // namespace catchy::utils
@@ -0,0 +1,96 @@
+#ifndef CATCHY_UTILS_GLOB_HPP
+#define CATCHY_UTILS_GLOB_HPP
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace catchy::utils {
+
+// Glob pattern compiled once into a small automaton and matched without
+// backtracking. Syntax (gitignore flavoured):
+//   *       any run of characters except '/'
+//   ?       any single character except '/'
+//   [abc]   character class; ranges (a-z) and negation ([!a] or [^a])
+//   **/     zero or more leading directories ("**/foo", "a/**/b")
+//   /**     everything inside a directory ("build/**")
+//   \x      the character x literally
+// The whole text must match.
+class Glob {
+public:
+    struct Token {
+        enum class Type : uint8_t {
+            Literal,   // The character `c`
+            AnyChar,   // Any character but '/'
+            AnyByte,   // Any character
+            Class,     // A character in `ranges`, or not in it when negated
+            Star,      // Any run of characters but '/'
+            StarCross, // Any run of characters
+            Skip       // Optionally skip the next `skip` tokens
+        };
+        Type type;
+        char c {0};
+        bool negated {false};
+        uint8_t skip {0};
+        std::vector<std::pair<unsigned char, unsigned char>> ranges;
+
+        bool accepts(unsigned char byte) const;
+    };
+
+    explicit Glob(std::string_view pattern);
+
+    bool matches(std::string_view text) const;
+
+    const std::string &pattern() const { return pattern_; }
+    const std::vector<Token> &tokens() const { return tokens_; }
+
+private:
+    std::string pattern_;
+    std::vector<Token> tokens_;
+    // Plain patterns skip the automaton entirely
+    bool is_literal_ {false};
+    bool is_suffix_ {false}; // "*" followed by a literal without '/'
+    std::string literal_;
+};
+
+// Many globs combined into one deterministic automaton, so matching a text
+// costs one table lookup per byte however many patterns there are. The DFA
+// is built eagerly by compile() over byte equivalence classes; past
+// max_states it falls back to matching each glob in turn. A compiled set
+// is immutable and safe to share between threads.
+class GlobSet {
+public:
+    static constexpr int no_match = -1;
+    static constexpr size_t max_states = 4096;
+
+    // `id` is reported on a match; ids should be non-negative
+    void add(std::string_view pattern, int id);
+    void compile();
+
+    // Greatest id among the patterns matching the whole text, or no_match
+    int best_match(std::string_view text) const;
+    bool matches(std::string_view text) const { return best_match(text) != no_match; }
+
+    bool empty() const { return globs_.empty(); }
+    size_t size() const { return globs_.size(); }
+    bool is_deterministic() const { return !fallback_; }
+
+private:
+    std::vector<Glob> globs_;
+    std::vector<int> ids_;
+
+    // Automaton: state 0 is the dead state
+    bool fallback_ {false};
+    uint32_t start_ {0};
+    size_t class_count_ {0};
+    uint8_t byte_class_[256] {};
+    std::vector<uint32_t> transitions_; // state * class_count_ + class
+    std::vector<int> accept_;
+};
+
+} // namespace catchy::utils
+
+#endif // CATCHY_UTILS_GLOB_HPP
@@ -0,0 +1,221 @@
+#include "ignore.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace catchy::utils {
+
+namespace fs = std::filesystem;
+
+void IgnoreFile::add_rules(std::string_view text) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = text.size();
+        }
+        std::string_view line = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        // Trailing spaces are ignored unless escaped
+        while (!line.empty() && line.back() == ' ' &&
+               !(line.size() >= 2 && line[line.size() - 2] == '\\')) {
+            line.remove_suffix(1);
+        }
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+
+        bool negated = false;
+        if (line.front() == '!') {
+            negated = true;
+            line.remove_prefix(1);
+        } else if (line.front() == '\\' && line.size() > 1 &&
+                   (line[1] == '!' || line[1] == '#')) {
+            line.remove_prefix(1);
+        }
+
+        bool directory_only = false;
+        if (!line.empty() && line.back() == '/') {
+            directory_only = true;
+            line.remove_suffix(1);
+        }
+
+        bool anchored = line.find('/') != std::string_view::npos;
+        if (!line.empty() && line.front() == '/') {
+            line.remove_prefix(1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+
+        int id = static_cast<int>(rules_.size());
+        rules_.push_back(Rule{negated, directory_only});
+        (anchored ? paths_ : names_).add(line, id);
+        if (!directory_only) {
+            (anchored ? paths_files_ : names_files_).add(line, id);
+        }
+    }
+
+    names_.compile();
+    names_files_.compile();
+    paths_.compile();
+    paths_files_.compile();
+}
+
+bool IgnoreFile::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    add_rules(buffer.str());
+    return true;
+}
+
+IgnoreMatch IgnoreFile::match(std::string_view relative_path, std::string_view name, bool is_directory) const {
+    // The last matching rule wins
+    const auto& names = is_directory ? names_ : names_files_;
+    const auto& paths = is_directory ? paths_ : paths_files_;
+    int best = names.best_match(name);
+    if (!paths.empty()) {
+        best = std::max(best, paths.best_match(relative_path));
+    }
+    if (best == GlobSet::no_match) {
+        return IgnoreMatch::None;
+    }
+    return rules_[best].negated ? IgnoreMatch::Included : IgnoreMatch::Ignored;
+}
+
+IgnorePatterns::IgnorePatterns(const std::vector<std::string>& patterns) {
+    for (const auto& pattern : patterns) {
+        if (pattern.empty()) {
+            continue;
+        }
+        bool is_path = pattern.find('/') != std::string::npos;
+        (is_path ? paths_ : components_).add(pattern, 0);
+    }
+    components_.compile();
+    paths_.compile();
+}
+
+bool IgnorePatterns::matches(std::string_view path, size_t root_length) const {
+    if (!paths_.empty() && paths_.matches(path)) {
+        return true;
+    }
+    if (components_.empty()) {
+        return false;
+    }
+    size_t pos = std::min(root_length, path.size());
+    while (pos <= path.size()) {
+        size_t end = path.find('/', pos);
+        if (end == std::string_view::npos) {
+            end = path.size();
+        }
+        if (end > pos && components_.matches(path.substr(pos, end - pos))) {
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+bool IgnorePatterns::matches_entry(std::string_view path, std::string_view name) const {
+    return (!components_.empty() && components_.matches(name)) ||
+           (!paths_.empty() && paths_.matches(path));
+}
+
+IgnoreScope::IgnoreScope(std::shared_ptr<const IgnoreScope> parent, IgnoreFile rules,
+                         std::string base, std::string prepend)
+    : parent_(std::move(parent)),
+      rules_(std::move(rules)),
+      base_(std::move(base)),
+      prepend_(std::move(prepend)) {}
+
+bool IgnoreScope::is_ignored(std::string_view path, std::string_view name, bool is_directory) const {
+    std::string scratch;
+    for (const IgnoreScope* scope = this; scope; scope = scope->parent_.get()) {
+        std::string_view relative = path.substr(std::min(scope->base_.size(), path.size()));
+        if (!scope->prepend_.empty()) {
+            scratch.assign(scope->prepend_);
+            scratch.append(relative);
+            relative = scratch;
+        }
+        switch (scope->rules_.match(relative, name, is_directory)) {
+            case IgnoreMatch::Ignored:
+                return true;
+            case IgnoreMatch::Included:
+                return false;
+            case IgnoreMatch::None:
+                break;
+        }
+    }
+    return false;
+}
+
+const std::vector<std::string>& ignore_file_names() {
+    static const std::vector<std::string> names = {".gitignore", ".catchyignore"};
+    return names;
+}
+
+std::shared_ptr<const IgnoreScope> load_enclosing_ignores(const std::string& directory) {
+    std::error_code error;
+    fs::path walk_root = fs::weakly_canonical(fs::absolute(directory, error), error);
+    if (error) {
+        return nullptr;
+    }
+    if (!walk_root.has_filename()) {
+        walk_root = walk_root.parent_path();
+    }
+
+    // Directories above the walk root, up to and including the repository root
+    std::vector<fs::path> ancestors;
+    fs::path repository_root;
+    if (fs::exists(walk_root / ".git", error)) {
+        repository_root = walk_root;
+    } else {
+        for (fs::path current = walk_root.parent_path(); ; current = current.parent_path()) {
+            ancestors.push_back(current);
+            if (fs::exists(current / ".git", error)) {
+                repository_root = current;
+                break;
+            }
+            if (current == current.parent_path()) {
+                break;
+            }
+        }
+    }
+    if (repository_root.empty()) {
+        return nullptr;
+    }
+
+    std::shared_ptr<const IgnoreScope> scope;
+    auto relative_to = [&](const fs::path& ancestor) {
+        return fs::relative(walk_root, ancestor, error).generic_string() + "/";
+    };
+
+    IgnoreFile exclude;
+    if (exclude.load((repository_root / ".git" / "info" / "exclude").string()) && !exclude.empty()) {
+        std::string prepend = repository_root == walk_root ? "" : relative_to(repository_root);
+        scope = std::make_shared<IgnoreScope>(scope, std::move(exclude), directory, prepend);
+    }
+
+    // Outermost first, so deeper files end up with higher precedence
+    for (auto it = ancestors.rbegin(); it != ancestors.rend(); ++it) {
+        IgnoreFile rules;
+        for (const auto& name : ignore_file_names()) {
+            rules.load((*it / name).string());
+        }
+        if (!rules.empty()) {
+            scope = std::make_shared<IgnoreScope>(scope, std::move(rules), directory, relative_to(*it));
+        }
+    }
+    return scope;
+}
+
+} // namespace catchy::utils
@@ -0,0 +1,95 @@
+#ifndef CATCHY_UTILS_IGNORE_HPP
+#define CATCHY_UTILS_IGNORE_HPP
+
+#pragma once
+
+#include "utils/glob.hpp"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace catchy::utils {
+
+enum class IgnoreMatch {
+    None,
+    Ignored,
+    Included
+};
+
+// Rules of one .gitignore-style file, compiled once when loaded
+class IgnoreFile {
+public:
+    // Append the rules in `text`; later rules take precedence
+    void add_rules(std::string_view text);
+    // Returns false if the file does not exist
+    bool load(const std::string &path);
+
+    // `relative_path` is relative to the directory holding the file
+    IgnoreMatch match(std::string_view relative_path, std::string_view name, bool is_directory) const;
+    bool empty() const { return rules_.empty(); }
+
+private:
+    struct Rule {
+        bool negated;
+        bool directory_only;
+    };
+    std::vector<Rule> rules_;
+    // Rule ids by what they are matched against: the entry name, or for
+    // patterns with a '/' the relative path. The *_files_ sets leave out
+    // directory-only rules.
+    GlobSet names_;
+    GlobSet names_files_;
+    GlobSet paths_;
+    GlobSet paths_files_;
+};
+
+// Patterns given with --ignore. Patterns without a '/' match any component
+// of a path (a file or directory name); the others match the whole path.
+class IgnorePatterns {
+public:
+    explicit IgnorePatterns(const std::vector<std::string> &patterns);
+
+    // Components in the first `root_length` characters of `path`, the
+    // directory the paths were listed from, are not matched
+    bool matches(std::string_view path, size_t root_length = 0) const;
+    // Cheaper check for walked entries, whose parents were already checked
+    bool matches_entry(std::string_view path, std::string_view name) const;
+    bool empty() const { return components_.empty() && paths_.empty(); }
+
+private:
+    GlobSet components_;
+    GlobSet paths_;
+};
+
+// Ignore files in effect for a directory: the files found in it plus those of
+// every enclosing directory. Scopes are immutable and shared by the
+// subdirectories walked from them, on any thread.
+class IgnoreScope {
+public:
+    // `base` is the directory prefix stripped from walked paths (with a
+    // trailing '/'); `prepend` is added back for scopes above the walk root
+    IgnoreScope(std::shared_ptr<const IgnoreScope> parent, IgnoreFile rules,
+                std::string base, std::string prepend = "");
+
+    // `path` as built by the walker, `name` its last component
+    bool is_ignored(std::string_view path, std::string_view name, bool is_directory) const;
+
+private:
+    std::shared_ptr<const IgnoreScope> parent_;
+    IgnoreFile rules_;
+    std::string base_;
+    std::string prepend_;
+};
+
+// Names of the per-directory ignore files, in increasing precedence
+const std::vector<std::string> &ignore_file_names();
+
+// Scope for walking `directory` (given with a trailing '/'): the repository's
+// .git/info/exclude plus the ignore files of the directories between the
+// repository root and `directory`. Null if none apply.
+std::shared_ptr<const IgnoreScope> load_enclosing_ignores(const std::string &directory);
+
+} // namespace catchy::utils
+
+#endif // CATCHY_UTILS_IGNORE_HPP
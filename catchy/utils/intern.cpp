@@ -0,0 +1,51 @@
+#include "intern.hpp"
+#include <mutex>
+#include <ostream>
+#include <unordered_set>
+
+namespace catchy::utils {
+
+namespace {
+
+struct TransparentHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+};
+
+struct Pool {
+    std::mutex mutex;
+    // Elements of an unordered_set keep their address across rehashing
+    std::unordered_set<std::string, TransparentHash, std::equal_to<>> strings;
+};
+
+Pool &pool() {
+    // Leaked so handles stay valid while other statics are destroyed
+    static Pool *instance = new Pool;
+    return *instance;
+}
+
+} // namespace
+
+const std::string &InternedString::empty() {
+    static const std::string value;
+    return value;
+}
+
+InternedString::InternedString(std::string_view text) : value_(&empty()) {
+    if (text.empty()) {
+        return;
+    }
+    auto &strings = pool();
+    std::lock_guard lock(strings.mutex);
+    auto it = strings.strings.find(text);
+    if (it == strings.strings.end()) {
+        it = strings.strings.emplace(text).first;
+    }
+    value_ = &*it;
+}
+
+std::ostream &operator<<(std::ostream &out, InternedString text) {
+    return out << text.str();
+}
+
+} // namespace catchy::utils
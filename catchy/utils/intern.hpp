@@ -0,0 +1,50 @@
+#ifndef CATCHY_UTILS_INTERN_HPP
+#define CATCHY_UTILS_INTERN_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+namespace catchy::utils {
+
+// Handle to a string stored once in a process-wide pool. Equal strings get
+// the same handle, so results of one file share its path and language, and
+// copies, equality and hashing cost a pointer. The pool is never freed.
+// Interning takes a lock; do it once per file, not per function.
+class InternedString {
+public:
+    InternedString() : value_(&empty()) {}
+    explicit InternedString(std::string_view text);
+
+    const std::string &str() const { return *value_; }
+    operator const std::string &() const { return *value_; }
+
+    friend bool operator==(InternedString lhs, InternedString rhs) { return lhs.value_ == rhs.value_; }
+    friend bool operator!=(InternedString lhs, InternedString rhs) { return lhs.value_ != rhs.value_; }
+    // Orders by content, so sorted output does not depend on interning order
+    friend bool operator<(InternedString lhs, InternedString rhs) {
+        return lhs.value_ != rhs.value_ && *lhs.value_ < *rhs.value_;
+    }
+
+    size_t hash() const { return std::hash<const void *>{}(value_); }
+
+private:
+    static const std::string &empty();
+
+    const std::string *value_;
+};
+
+std::ostream &operator<<(std::ostream &out, InternedString text);
+
+} // namespace catchy::utils
+
+template <>
+struct std::hash<catchy::utils::InternedString> {
+    size_t operator()(catchy::utils::InternedString text) const { return text.hash(); }
+};
+
+#endif // CATCHY_UTILS_INTERN_HPP
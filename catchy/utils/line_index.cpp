@@ -0,0 +1,43 @@
+#include "line_index.hpp"
+#include <cstring>
+
+namespace catchy::utils {
+
+LineIndex::LineIndex(std::string_view source) : source_(source) {
+    line_starts_.push_back(0);
+    const char* begin = source.data();
+    const char* end = begin + source.size();
+    for (const char* p = begin; p < end;) {
+        auto newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!newline) {
+            break;
+        }
+        p = newline + 1;
+        line_starts_.push_back(static_cast<size_t>(p - begin));
+    }
+}
+
+std::string_view LineIndex::line(size_t line_number) const {
+    if (line_number == 0 || line_number > line_starts_.size()) {
+        return {};
+    }
+    size_t start = line_starts_[line_number - 1];
+    size_t end = line_number < line_starts_.size() ? line_starts_[line_number] - 1 : source_.size();
+    auto text = source_.substr(start, end - start);
+    if (!text.empty() && text.back() == '\r') {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+std::string_view trim(std::string_view text) {
+    const char* whitespace = " \t\r\n";
+    size_t first = text.find_first_not_of(whitespace);
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    size_t last = text.find_last_not_of(whitespace);
+    return text.substr(first, last - first + 1);
+}
+
+} // namespace catchy::utils
@@ -0,0 +1,31 @@
+#ifndef CATCHY_UTILS_LINE_INDEX_HPP
+#define CATCHY_UTILS_LINE_INDEX_HPP
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+namespace catchy::utils {
+
+// Offsets of every line start in a buffer, for looking up source lines
+// without rescanning. The buffer must outlive the index.
+class LineIndex {
+public:
+    explicit LineIndex(std::string_view source);
+
+    // 1-based line number; empty for lines past the end
+    std::string_view line(size_t line_number) const;
+    size_t line_count() const { return line_starts_.size(); }
+
+private:
+    std::string_view source_;
+    std::vector<size_t> line_starts_;
+};
+
+// Strip leading and trailing whitespace
+std::string_view trim(std::string_view text);
+
+} // namespace catchy::utils
+
+#endif // CATCHY_UTILS_LINE_INDEX_HPP
@@ -0,0 +1,114 @@
+#include "sniff.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace catchy::utils {
+
+namespace {
+
+// Generated code that is marked as such is usually marked near the top
+constexpr size_t marker_window = 2048;
+// Minified sources pack whole files onto a few lines
+constexpr size_t minified_min_sample = 2048;
+constexpr size_t minified_line_length = 300;
+
+// `truncated` allows a sequence cut off by the end of the sample
+bool is_valid_utf8(std::string_view text, bool truncated) {
+    size_t i = 0;
+    while (i < text.size()) {
+        auto byte = static_cast<unsigned char>(text[i]);
+        if (byte < 0x80) {
+            ++i;
+            continue;
+        }
+        size_t length;
+        uint32_t minimum;
+        if ((byte & 0xe0) == 0xc0) {
+            length = 2;
+            minimum = 0x80;
+        } else if ((byte & 0xf0) == 0xe0) {
+            length = 3;
+            minimum = 0x800;
+        } else if ((byte & 0xf8) == 0xf0) {
+            length = 4;
+            minimum = 0x10000;
+        } else {
+            return false;
+        }
+        if (i + length > text.size()) {
+            return truncated;
+        }
+        uint32_t code_point = byte & (0x7f >> length);
+        for (size_t k = 1; k < length; ++k) {
+            auto next = static_cast<unsigned char>(text[i + k]);
+            if ((next & 0xc0) != 0x80) {
+                return false;
+            }
+            code_point = (code_point << 6) | (next & 0x3f);
+        }
+        if (code_point < minimum || code_point > 0x10ffff ||
+            (code_point >= 0xd800 && code_point <= 0xdfff)) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+bool has_generated_marker(std::string_view text) {
+    text = text.substr(0, marker_window);
+    return text.find("@generated") != std::string_view::npos ||
+           text.find("DO NOT EDIT") != std::string_view::npos;
+}
+
+} // namespace
+
+SkipReason sniff_content(std::string_view content) {
+    std::string_view sample = content.substr(0, sniff_size);
+    if (std::memchr(sample.data(), '\0', sample.size())) {
+        return SkipReason::Binary;
+    }
+    if (!is_valid_utf8(sample, sample.size() < content.size())) {
+        return SkipReason::InvalidUtf8;
+    }
+    if (has_generated_marker(sample)) {
+        return SkipReason::Generated;
+    }
+    if (sample.size() >= minified_min_sample) {
+        size_t lines = 1 + static_cast<size_t>(std::count(sample.begin(), sample.end(), '\n'));
+        if (sample.size() / lines > minified_line_length) {
+            return SkipReason::Minified;
+        }
+    }
+    return SkipReason::None;
+}
+
+const char *describe(SkipReason reason) {
+    switch (reason) {
+        case SkipReason::None: return "none";
+        case SkipReason::Binary: return "binary";
+        case SkipReason::InvalidUtf8: return "invalid UTF-8";
+        case SkipReason::Generated: return "generated";
+        case SkipReason::Minified: return "minified";
+        case SkipReason::Timeout: return "parse timeout";
+        case SkipReason::NodeLimit: return "node budget";
+        case SkipReason::Cancelled: return "cancelled";
+        default: return "unknown";
+    }
+}
+
+const char *identifier(SkipReason reason) {
+    switch (reason) {
+        case SkipReason::None: return "none";
+        case SkipReason::Binary: return "binary";
+        case SkipReason::InvalidUtf8: return "invalid_utf8";
+        case SkipReason::Generated: return "generated";
+        case SkipReason::Minified: return "minified";
+        case SkipReason::Timeout: return "timeout";
+        case SkipReason::NodeLimit: return "node_limit";
+        case SkipReason::Cancelled: return "cancelled";
+        default: return "unknown";
+    }
+}
+
+} // namespace catchy::utils
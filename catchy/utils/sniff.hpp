@@ -0,0 +1,38 @@
+#ifndef CATCHY_UTILS_SNIFF_HPP
+#define CATCHY_UTILS_SNIFF_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace catchy::utils {
+
+// Why a file is not worth parsing
+enum class SkipReason : uint8_t {
+    None,
+    Binary,      // NUL bytes
+    InvalidUtf8, // Not text in any encoding we parse
+    Generated,   // "@generated" or "DO NOT EDIT" marker
+    Minified,    // Extreme average line length
+    // Set by the analyzer once parsing has started
+    Timeout,     // Parse took longer than its budget
+    NodeLimit,   // Scoring walk hit its node or depth budget
+    Cancelled,   // Parse interrupted by a cancellation request
+    Count
+};
+
+// Bytes at the start of a file that are inspected
+constexpr size_t sniff_size = 8192;
+
+// Cheap check of the start of a file's content, run before parsing
+SkipReason sniff_content(std::string_view content);
+
+const char *describe(SkipReason reason);
+// Stable snake_case name for machine-readable output
+const char *identifier(SkipReason reason);
+
+} // namespace catchy::utils
+
+#endif // CATCHY_UTILS_SNIFF_HPP
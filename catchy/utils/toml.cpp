@@ -0,0 +1,276 @@
+#include "toml.hpp"
+#include <cctype>
+#include <stdexcept>
+
+namespace catchy::utils {
+
+namespace {
+
+class TomlParser {
+public:
+    TomlParser(std::string_view text, const std::string& source) : text_(text), source_(source) {}
+
+    std::vector<TomlTable> parse() {
+        std::vector<TomlTable> tables(1);
+        while (true) {
+            skip_blank_lines();
+            if (at_end()) {
+                break;
+            }
+            if (peek() == '[') {
+                tables.push_back(parse_header());
+            } else {
+                auto& table = tables.back();
+                TomlEntry entry;
+                entry.line = line_;
+                entry.key = parse_key();
+                for (const auto& existing : table.entries) {
+                    if (existing.key == entry.key) {
+                        fail("duplicate key '" + entry.key + "'");
+                    }
+                }
+                skip_spaces();
+                expect('=');
+                skip_spaces();
+                entry.value = parse_value();
+                table.entries.push_back(std::move(entry));
+            }
+            end_line();
+        }
+        return tables;
+    }
+
+private:
+    bool at_end() const { return pos_ >= text_.size(); }
+    char peek() const { return at_end() ? '\0' : text_[pos_]; }
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error(source_ + ":" + std::to_string(line_) + ": " + message);
+    }
+
+    void expect(char c) {
+        if (peek() != c) {
+            fail(std::string("expected '") + c + "'");
+        }
+        ++pos_;
+    }
+
+    void skip_spaces() {
+        while (peek() == ' ' || peek() == '\t') {
+            ++pos_;
+        }
+    }
+
+    void skip_comment() {
+        if (peek() == '#') {
+            while (!at_end() && peek() != '\n') {
+                ++pos_;
+            }
+        }
+    }
+
+    // Whitespace, comments and newlines, e.g. between array elements
+    void skip_whitespace() {
+        while (true) {
+            skip_spaces();
+            skip_comment();
+            if (peek() == '\r' || peek() == '\n') {
+                line_ += peek() == '\n';
+                ++pos_;
+            } else {
+                return;
+            }
+        }
+    }
+
+    void skip_blank_lines() { skip_whitespace(); }
+
+    // Only a comment may follow a key/value pair or header on its line
+    void end_line() {
+        skip_spaces();
+        skip_comment();
+        if (peek() == '\r') {
+            ++pos_;
+        }
+        if (!at_end()) {
+            if (peek() != '\n') {
+                fail("expected the end of the line");
+            }
+            ++pos_;
+            ++line_;
+        }
+    }
+
+    static bool is_bare_key_char(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-';
+    }
+
+    std::string parse_key() {
+        if (peek() == '"') {
+            return parse_basic_string();
+        }
+        if (peek() == '\'') {
+            return parse_literal_string();
+        }
+        size_t start = pos_;
+        while (is_bare_key_char(peek())) {
+            ++pos_;
+        }
+        if (pos_ == start) {
+            fail("expected a key");
+        }
+        if (peek() == '.') {
+            fail("dotted keys are not supported");
+        }
+        return std::string(text_.substr(start, pos_ - start));
+    }
+
+    TomlTable parse_header() {
+        TomlTable table;
+        table.line = line_;
+        expect('[');
+        if (peek() == '[') {
+            table.is_array_element = true;
+            ++pos_;
+        }
+        skip_spaces();
+        table.name = parse_key();
+        skip_spaces();
+        expect(']');
+        if (table.is_array_element) {
+            expect(']');
+        }
+        return table;
+    }
+
+    TomlValue parse_value() {
+        char c = peek();
+        if (c == '"') {
+            return parse_basic_string();
+        }
+        if (c == '\'') {
+            return parse_literal_string();
+        }
+        if (c == '[') {
+            return parse_array();
+        }
+        if (text_.substr(pos_, 4) == "true") {
+            pos_ += 4;
+            return true;
+        }
+        if (text_.substr(pos_, 5) == "false") {
+            pos_ += 5;
+            return false;
+        }
+        if (c == '-' || c == '+' || std::isdigit(static_cast<unsigned char>(c))) {
+            return parse_integer();
+        }
+        fail("expected a value");
+    }
+
+    int64_t parse_integer() {
+        std::string digits;
+        if (peek() == '-' || peek() == '+') {
+            digits += text_[pos_++];
+        }
+        while (std::isdigit(static_cast<unsigned char>(peek())) || peek() == '_') {
+            if (peek() != '_') {
+                digits += peek();
+            }
+            ++pos_;
+        }
+        if (digits.empty() || !std::isdigit(static_cast<unsigned char>(digits.back()))) {
+            fail("invalid integer");
+        }
+        try {
+            return std::stoll(digits);
+        } catch (const std::exception&) {
+            fail("integer out of range");
+        }
+    }
+
+    std::string parse_basic_string() {
+        expect('"');
+        std::string out;
+        while (!at_end() && peek() != '"') {
+            char c = text_[pos_++];
+            if (c == '\n') {
+                fail("unterminated string");
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            char escape = peek();
+            ++pos_;
+            switch (escape) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                default: fail(std::string("unsupported escape '\\") + escape + "'");
+            }
+        }
+        expect('"');
+        return out;
+    }
+
+    std::string parse_literal_string() {
+        expect('\'');
+        size_t start = pos_;
+        while (!at_end() && peek() != '\'' && peek() != '\n') {
+            ++pos_;
+        }
+        std::string out(text_.substr(start, pos_ - start));
+        expect('\'');
+        return out;
+    }
+
+    std::vector<std::string> parse_array() {
+        expect('[');
+        std::vector<std::string> values;
+        while (true) {
+            skip_whitespace();
+            if (peek() == ']') {
+                ++pos_;
+                return values;
+            }
+            if (peek() == '"') {
+                values.push_back(parse_basic_string());
+            } else if (peek() == '\'') {
+                values.push_back(parse_literal_string());
+            } else {
+                fail("only arrays of strings are supported");
+            }
+            skip_whitespace();
+            if (peek() == ',') {
+                ++pos_;
+            } else if (peek() != ']') {
+                fail("expected ',' or ']'");
+            }
+        }
+    }
+
+    std::string_view text_;
+    const std::string& source_;
+    size_t pos_ {0};
+    size_t line_ {1};
+};
+
+} // namespace
+
+std::vector<TomlTable> parse_toml(std::string_view text, const std::string& source) {
+    return TomlParser(text, source).parse();
+}
+
+const char* toml_type_name(const TomlValue& value) {
+    switch (value.index()) {
+        case 0: return "a boolean";
+        case 1: return "an integer";
+        case 2: return "a string";
+        default: return "an array";
+    }
+}
+
+} // namespace catchy::utils
@@ -0,0 +1,42 @@
+#ifndef CATCHY_UTILS_TOML_HPP
+#define CATCHY_UTILS_TOML_HPP
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace catchy::utils {
+
+// The subset of TOML used by catchy's config files: [tables],
+// [[arrays of tables]] and keys holding strings, integers, booleans or
+// arrays of strings. Inline tables, dotted keys and dates are not supported.
+using TomlValue = std::variant<bool, int64_t, std::string, std::vector<std::string>>;
+
+struct TomlEntry {
+    std::string key;
+    TomlValue value;
+    size_t line;
+};
+
+struct TomlTable {
+    // Empty for the top-level table
+    std::string name;
+    bool is_array_element {false};
+    size_t line {0};
+    std::vector<TomlEntry> entries;
+};
+
+// Tables in document order, starting with the top-level one. Throws
+// std::runtime_error naming `source` and the line on malformed input.
+std::vector<TomlTable> parse_toml(std::string_view text, const std::string &source);
+
+// Name of the value's type for error messages
+const char *toml_type_name(const TomlValue &value);
+
+} // namespace catchy::utils
+
+#endif // CATCHY_UTILS_TOML_HPP
@@ -0,0 +1,69 @@
+#ifndef CATCHY_TESTS_CHECK_HPP
+#define CATCHY_TESTS_CHECK_HPP
+
+#pragma once
+
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Just enough of a test harness for the parsers: TEST registers a function,
+// CHECK reports a failed condition and keeps going, and main runs every test
+// (or those named on the command line) and fails if any check did.
+namespace catchy::test {
+
+struct Case {
+    const char *name;
+    void (*run)();
+};
+
+inline std::vector<Case> &cases() {
+    static std::vector<Case> all;
+    return all;
+}
+
+inline size_t &failures() {
+    static size_t count = 0;
+    return count;
+}
+
+struct Registration {
+    Registration(const char *name, void (*run)()) { cases().push_back({name, run}); }
+};
+
+inline void check(bool passed, const char *expression, const char *file, int line) {
+    if (!passed) {
+        std::cerr << file << ":" << line << ": check failed: " << expression << "\n";
+        failures()++;
+    }
+}
+
+// Whether `statement` throws a std::exception whose message contains `message`
+inline bool throws(const std::function<void()> &statement, std::string_view message) {
+    try {
+        statement();
+    } catch (const std::exception &e) {
+        if (std::string_view(e.what()).find(message) != std::string_view::npos) {
+            return true;
+        }
+        std::cerr << "unexpected error: " << e.what() << "\n";
+    }
+    return false;
+}
+
+} // namespace catchy::test
+
+#define TEST(name)                                                                \
+    static void name();                                                           \
+    static const catchy::test::Registration name##_registration(#name, name);      \
+    static void name()
+
+#define CHECK(expression) catchy::test::check((expression), #expression, __FILE__, __LINE__)
+
+#define CHECK_THROWS(statement, message) \
+    catchy::test::check(catchy::test::throws([&] { statement; }, message), #statement " throws " message, __FILE__, __LINE__)
+
+#endif // CATCHY_TESTS_CHECK_HPP
@@ -0,0 +1,91 @@
+#include "check.hpp"
+#include "utils/glob.hpp"
+#include "utils/ignore.hpp"
+
+using catchy::utils::Glob;
+using catchy::utils::GlobSet;
+using catchy::utils::IgnoreFile;
+using catchy::utils::IgnoreMatch;
+
+TEST(glob_wildcards) {
+    CHECK(Glob("*.cpp").matches("main.cpp"));
+    CHECK(!Glob("*.cpp").matches("src/main.cpp"));
+    CHECK(Glob("?.py").matches("a.py"));
+    CHECK(!Glob("?.py").matches("/.py"));
+    CHECK(Glob("a\\*b").matches("a*b"));
+    CHECK(!Glob("a\\*b").matches("axb"));
+}
+
+TEST(glob_classes) {
+    Glob range("[a-c]x");
+    CHECK(range.matches("ax"));
+    CHECK(range.matches("cx"));
+    CHECK(!range.matches("dx"));
+
+    for (const char *pattern : {"[!a-c]x", "[^a-c]x"}) {
+        Glob negated(pattern);
+        CHECK(negated.matches("dx"));
+        CHECK(!negated.matches("bx"));
+        CHECK(!negated.matches("/x"));
+    }
+
+    Glob set("test_[0-9][0-9].py");
+    CHECK(set.matches("test_42.py"));
+    CHECK(!set.matches("test_4a.py"));
+}
+
+TEST(glob_leading_globstar) {
+    Glob glob("**/gen/*.cc");
+    CHECK(glob.matches("gen/a.cc"));
+    CHECK(glob.matches("src/gen/a.cc"));
+    CHECK(glob.matches("a/b/c/gen/a.cc"));
+    CHECK(!glob.matches("src/gen/sub/a.cc"));
+    CHECK(!glob.matches("src/agen/a.cc"));
+
+    Glob middle("a/**/b");
+    CHECK(middle.matches("a/b"));
+    CHECK(middle.matches("a/x/y/b"));
+    CHECK(!middle.matches("a/xb"));
+}
+
+TEST(glob_trailing_globstar) {
+    Glob glob("legacy/**");
+    CHECK(glob.matches("legacy/a.cpp"));
+    CHECK(glob.matches("legacy/deep/er/a.cpp"));
+    CHECK(!glob.matches("legacy"));
+    CHECK(!glob.matches("legacyish/a.cpp"));
+}
+
+TEST(glob_set_reports_greatest_id) {
+    GlobSet set;
+    set.add("*.cc", 0);
+    set.add("gen_*", 1);
+    set.add("**/third_party/**", 2);
+    set.compile();
+    CHECK(set.is_deterministic());
+    CHECK(set.best_match("a.cc") == 0);
+    CHECK(set.best_match("gen_a.cc") == 1);
+    CHECK(set.best_match("x/third_party/gen_a.cc") == 2);
+    CHECK(set.best_match("a.py") == GlobSet::no_match);
+}
+
+TEST(ignore_last_rule_wins) {
+    IgnoreFile rules;
+    rules.add_rules("*.log\n!keep.log\n");
+    CHECK(rules.match("a.log", "a.log", false) == IgnoreMatch::Ignored);
+    CHECK(rules.match("keep.log", "keep.log", false) == IgnoreMatch::Included);
+    CHECK(rules.match("a.txt", "a.txt", false) == IgnoreMatch::None);
+
+    IgnoreFile reversed;
+    reversed.add_rules("!keep.log\n*.log\n");
+    CHECK(reversed.match("keep.log", "keep.log", false) == IgnoreMatch::Ignored);
+}
+
+TEST(ignore_directory_and_anchored_rules) {
+    IgnoreFile rules;
+    rules.add_rules("# comment\nbuild/\n/top.cc\n");
+    CHECK(rules.match("build", "build", true) == IgnoreMatch::Ignored);
+    CHECK(rules.match("build", "build", false) == IgnoreMatch::None);
+    CHECK(rules.match("top.cc", "top.cc", false) == IgnoreMatch::Ignored);
+    CHECK(rules.match("src/top.cc", "top.cc", false) == IgnoreMatch::None);
+}
@@ -0,0 +1,32 @@
+#include "check.hpp"
+#include <spdlog/spdlog.h>
+#include <string_view>
+
+int main(int argc, char **argv) {
+    spdlog::set_level(spdlog::level::off);
+
+    size_t run = 0;
+    for (const auto &test : catchy::test::cases()) {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; ++i) {
+            selected = selected || std::string_view(argv[i]) == test.name;
+        }
+        if (!selected) {
+            continue;
+        }
+        size_t failures = catchy::test::failures();
+        try {
+            test.run();
+        } catch (const std::exception &e) {
+            std::cerr << test.name << ": unexpected error: " << e.what() << "\n";
+            catchy::test::failures()++;
+        }
+        std::cout << (catchy::test::failures() == failures ? "ok   " : "FAIL ") << test.name << "\n";
+        run++;
+    }
+    if (run == 0) {
+        std::cerr << "no tests selected\n";
+        return 1;
+    }
+    return catchy::test::failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+#include "check.hpp"
+#include "analysis/project_config.hpp"
+
+using catchy::analysis::ProjectConfig;
+
+namespace {
+
+const std::string config_path = "/repo/.catchy.toml";
+
+ProjectConfig parse(std::string_view text) {
+    return ProjectConfig::parse(text, config_path);
+}
+
+} // namespace
+
+TEST(config_later_sections_win) {
+    auto config = parse(
+        "threshold = 15\n"
+        "[[path]]\n"
+        "match = \"legacy/keep/**\"\n"
+        "threshold = 5\n"
+        "[[path]]\n"
+        "match = \"legacy/**\"\n"
+        "threshold = 40\n"
+        "[[path]]\n"
+        "match = \"legacy/new\"\n"
+        "threshold = 10\n");
+    CHECK(config.threshold() == 15u);
+    CHECK(!config.resolve("/repo/src/a.cpp").threshold);
+    CHECK(config.resolve("/repo/legacy/a.cpp").threshold == 40u);
+    // Declared before legacy/**, so overridden by it
+    CHECK(config.resolve("/repo/legacy/keep/a.cpp").threshold == 40u);
+    // Declared after, and applies to everything below the directory
+    CHECK(config.resolve("/repo/legacy/new/a.cpp").threshold == 10u);
+    CHECK(config.resolve("/repo/legacy/new/sub/a.cpp").threshold == 10u);
+}
+
+TEST(config_globs_and_globstars) {
+    auto config = parse(
+        "languages = [\"cpp\", \"python\"]\n"
+        "ignore = [\"*.pb.cc\"]\n"
+        "[[path]]\n"
+        "match = \"**/testdata\"\n"
+        "skip = true\n"
+        "[[path]]\n"
+        "match = \"services/*-api\"\n"
+        "threshold = 10\n"
+        "languages = [\"python\"]\n");
+    CHECK(config.resolve("/repo/testdata/a.py").skip);
+    CHECK(config.resolve("/repo/x/y/testdata/a.py").skip);
+    CHECK(!config.resolve("/repo/x/testdata2/a.py").skip);
+    CHECK(config.resolve("/repo/src/a.pb.cc").skip);
+
+    auto api = config.resolve("/repo/services/user-api/a.py");
+    CHECK(api.threshold == 10u);
+    CHECK(api.allows_language("python"));
+    CHECK(!api.allows_language("cpp"));
+    auto other = config.resolve("/repo/services/worker/a.cpp");
+    CHECK(!other.threshold);
+    CHECK(other.allows_language("cpp"));
+}
+
+TEST(config_paths_outside_the_root) {
+    auto config = parse(
+        "[[path]]\n"
+        "match = \"**\"\n"
+        "threshold = 3\n");
+    CHECK(config.resolve("/repo/a.cpp").threshold == 3u);
+    CHECK(!config.resolve("/elsewhere/a.cpp").threshold);
+    CHECK(!config.resolve("/repository/a.cpp").threshold);
+}
+
+TEST(config_errors) {
+    CHECK_THROWS(parse("[unknown]\na = 1\n"), "/repo/.catchy.toml:1: unknown table 'unknown'");
+    CHECK_THROWS(parse("[[output]]\nrollup = true\n"), "unknown table 'output'");
+    CHECK_THROWS(parse("colour = true\n"), "unknown key 'colour'");
+    CHECK_THROWS(parse("threshold = -1\n"), "must not be negative");
+    CHECK_THROWS(parse("threshold = \"15\"\n"), "'threshold' must be an integer, not a string");
+    CHECK_THROWS(parse("[[path]]\nthreshold = 1\n"), "[[path]] needs a 'match' pattern");
+}
@@ -0,0 +1,89 @@
+#include "check.hpp"
+#include "analysis/snapshot.hpp"
+#include <filesystem>
+#include <unistd.h>
+
+using catchy::analysis::SnapshotReader;
+using catchy::analysis::SnapshotRecord;
+using catchy::analysis::SnapshotWriter;
+
+namespace {
+
+std::string temp_path(const std::string &name) {
+    return (std::filesystem::temp_directory_path() /
+            ("catchy_test_" + std::to_string(getpid()) + "_" + name)).string();
+}
+
+SnapshotRecord record(std::string file, std::string function, size_t line, size_t complexity) {
+    SnapshotRecord result;
+    result.file_path = std::move(file);
+    result.function_name = std::move(function);
+    result.language = "cpp";
+    result.start_line = line;
+    result.end_line = line + 10;
+    result.complexity = complexity;
+    return result;
+}
+
+} // namespace
+
+TEST(snapshot_round_trip) {
+    std::vector<SnapshotRecord> written{
+        record("/src/proj/a \"quoted\".cpp", "operator\\", 1, 3),
+        record("/src/proj/b.cpp", "tab\there\nnewline", 20, 0),
+        record("/src/proj/c.cpp", std::string("control\x01\x1f") + "caf\xc3\xa9 \xf0\x9f\x98\x80", 7, 12),
+        record("/other/d.py", "Outer.inner", 4, 25),
+    };
+    written[1].below_threshold = true;
+    written[2].approximate = true;
+    written[3].language = "python";
+
+    auto path = temp_path("round_trip.ndjson");
+    SnapshotWriter writer(path, false, "/src/proj");
+    for (const auto &r : written) {
+        writer.write(r);
+    }
+    writer.close();
+
+    SnapshotReader reader(path);
+    CHECK(reader.is_sorted());
+    std::vector<SnapshotRecord> read;
+    SnapshotRecord r;
+    while (reader.next(r)) {
+        read.push_back(r);
+    }
+    std::filesystem::remove(path);
+
+    CHECK(read.size() == written.size());
+    for (size_t i = 0; i < std::min(read.size(), written.size()); ++i) {
+        CHECK(read[i].function_name == written[i].function_name);
+        CHECK(read[i].language == written[i].language);
+        CHECK(read[i].start_line == written[i].start_line);
+        CHECK(read[i].end_line == written[i].end_line);
+        CHECK(read[i].complexity == written[i].complexity);
+        CHECK(read[i].approximate == written[i].approximate);
+        CHECK(read[i].below_threshold == written[i].below_threshold);
+    }
+    if (read.size() == written.size()) {
+        // Paths under the root are written relative to it
+        CHECK(read[0].file_path == "a \"quoted\".cpp");
+        CHECK(read[1].file_path == "b.cpp");
+        CHECK(read[3].file_path == "/other/d.py");
+    }
+}
+
+TEST(snapshot_reads_unicode_escapes) {
+    auto path = temp_path("unicode.ndjson");
+    {
+        std::ofstream out(path);
+        out << "{\"file\":\"a.cpp\",\"function\":\"caf\\u00e9 \\ud83d\\ude00\",\"language\":\"cpp\","
+               "\"start_line\":1,\"end_line\":2,\"complexity\":3}\n";
+    }
+    SnapshotReader reader(path);
+    CHECK(!reader.is_sorted());
+    SnapshotRecord r;
+    CHECK(reader.next(r));
+    CHECK(r.function_name == "caf\xc3\xa9 \xf0\x9f\x98\x80");
+    CHECK(!reader.next(r));
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,52 @@
+#include "check.hpp"
+#include "utils/toml.hpp"
+
+using catchy::utils::parse_toml;
+
+TEST(toml_tables_and_values) {
+    auto tables = parse_toml(
+        "threshold = 15 # default\n"
+        "languages = [\"cpp\", 'python',]\n"
+        "\n"
+        "[output]\n"
+        "rollup = true\n"
+        "snapshot = \"a\\tb\\\"c\\\\d\"\n"
+        "[[path]]\n"
+        "match = 'legacy/**'\n"
+        "[[path]]\n"
+        "threshold = -3\n",
+        "test.toml");
+    CHECK(tables.size() == 4);
+    CHECK(tables[0].name.empty());
+    CHECK(std::get<int64_t>(tables[0].entries[0].value) == 15);
+    CHECK((std::get<std::vector<std::string>>(tables[0].entries[1].value) ==
+           std::vector<std::string>{"cpp", "python"}));
+    CHECK(tables[1].name == "output" && !tables[1].is_array_element);
+    CHECK(std::get<bool>(tables[1].entries[0].value));
+    CHECK(std::get<std::string>(tables[1].entries[1].value) == "a\tb\"c\\d");
+    CHECK(tables[2].name == "path" && tables[2].is_array_element);
+    CHECK(std::get<std::string>(tables[2].entries[0].value) == "legacy/**");
+    CHECK(tables[3].line == 9);
+    CHECK(std::get<int64_t>(tables[3].entries[0].value) == -3);
+}
+
+TEST(toml_duplicate_keys) {
+    CHECK_THROWS(parse_toml("a = 1\na = 2\n", "dup.toml"), "dup.toml:2: duplicate key 'a'");
+    CHECK_THROWS(parse_toml("[output]\nrollup = true\nrollup = false\n", "dup.toml"), "duplicate key 'rollup'");
+    // The same key in two [[path]] elements is not a duplicate
+    CHECK(parse_toml("[[path]]\nmatch = 'a'\n[[path]]\nmatch = 'b'\n", "ok.toml").size() == 3);
+}
+
+TEST(toml_bad_escapes) {
+    CHECK_THROWS(parse_toml("a = \"\\q\"\n", "esc.toml"), "esc.toml:1: unsupported escape '\\q'");
+    CHECK_THROWS(parse_toml("a = \"\\u00e9\"\n", "esc.toml"), "unsupported escape");
+    CHECK_THROWS(parse_toml("a = \"open\nb = 1\n", "esc.toml"), "unterminated string");
+}
+
+TEST(toml_malformed_lines) {
+    CHECK_THROWS(parse_toml("a.b = 1\n", "bad.toml"), "dotted keys are not supported");
+    CHECK_THROWS(parse_toml("a = 1 2\n", "bad.toml"), "expected the end of the line");
+    CHECK_THROWS(parse_toml("a = [1, 2]\n", "bad.toml"), "only arrays of strings are supported");
+    CHECK_THROWS(parse_toml("a = 99999999999999999999\n", "bad.toml"), "integer out of range");
+    CHECK_THROWS(parse_toml("a =\n", "bad.toml"), "expected a value");
+}